@@ -1,7 +1,7 @@
 #include "Application.h"
 #include "imgui/imgui.h"
-#include <chrono>
 #include "classes/AstroBots.h"
+#include "classes/AstroClock.h"
 
 namespace ClassGame {
         //
@@ -11,9 +11,11 @@ namespace ClassGame {
         bool gameOver = false;
         int gameWinner = -1;
 
-        // Frame rate limiter for AstroBots (30Hz = 33.33ms per frame)
-        static auto lastAstroBotsUpdate = std::chrono::steady_clock::now();
-        static constexpr double ASTROBOTS_UPDATE_INTERVAL_MS = 1000.0 / 30.0;  // 30 Hz
+        // AstroBots turns run on the simulation thread's fixed-step clock (30 Hz
+        // by default), decoupled from the render frame rate; frames in between
+        // are interpolated
+        static AstroClock astroClock;
+        static bool astroInterpolate = true;
 
         //
         // game starting point
@@ -55,12 +57,15 @@ namespace ClassGame {
                 } else {
                     AstroBots *astroGame = dynamic_cast<AstroBots*>(game);
                     if (astroGame) {
-                        auto now = std::chrono::steady_clock::now();
-                        double elapsedMs = std::chrono::duration<double, std::milli>(now - lastAstroBotsUpdate).count();
-                        if (elapsedMs >= ASTROBOTS_UPDATE_INTERVAL_MS) {
-                            astroGame->endTurn();
-                            lastAstroBotsUpdate = now;
+                        float tickRate = (float)astroClock.tickRate;
+                        if (ImGui::SliderFloat("Tick rate (Hz)", &tickRate, 1.0f, 240.0f, "%.0f")) {
+                            astroClock.tickRate = tickRate;
                         }
+                        ImGui::SliderInt("Max catch-up", &astroClock.maxCatchUp, 1, 16);
+                        ImGui::Checkbox("Turbo", &astroClock.turbo);
+                        ImGui::SameLine();
+                        ImGui::Checkbox("Interpolate", &astroInterpolate);
+                        astroGame->SetClock(astroClock, astroInterpolate);
                     } else {
                         ImGui::Text("Current Player Number: %d", game->getCurrentPlayer()->playerNumber());
                         std::string stateString = game->stateString();
@@ -70,8 +75,9 @@ namespace ClassGame {
                         for(int y=0; y<height; y++) {
                             ImGui::Text("%s", stateString.substr(y*stride,stride).c_str());
                         }
+                        // AstroBots' state string is a binary snapshot, not something to print
+                        ImGui::Text("Current Board State: %s", stateString.c_str());
                     }
-                    ImGui::Text("Current Board State: %s", game->stateString().c_str());
                 }
                 ImGui::End();
 
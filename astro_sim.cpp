@@ -0,0 +1,752 @@
+// astro_sim: headless AstroBots runner
+//
+// Steps matches through AstroMatch as fast as the CPU allows, without opening a
+// window or linking ImGui. Intended for build servers and bot evaluation.
+//
+//   astro_sim [--matches N] [--seed S] [--log] [--record FILE] [--compiled] [--batched]
+//             [--simultaneous [--script-threads T]] [--allocs] [--effects [--particle-cap N]]
+//   astro_sim --replay FILE [--log]
+//   astro_sim --fork TURN [--seed S] [--ships A,B,...]
+//   astro_sim --sim-thread [--seed S] [--ships A,B,...]
+//   astro_sim --vm-bench COPIES [--seed S]
+//   astro_sim --fx-bench PARTICLES [--seed S]
+//   astro_sim --spawn-bench ASTEROIDS [--seed S]
+//   astro_sim --scan-bench OBJECTS [--seed S]
+//   astro_sim --vm-diff [--matches N] [--seed S] [--ships A,B,...]
+//   astro_sim --tournament [--ships A,B,...] [--per-match K] [--rounds N] [--seed S] [--threads T] [--verbose]
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "classes/AstroEffects.h"
+#include "classes/AstroMatch.h"
+#include "classes/AstroReplay.h"
+#include "classes/AstroSimThread.h"
+#include "classes/AstroSnapshot.h"
+#include "classes/AstroTournament.h"
+
+// ===== Allocation counting =====
+// Every plain new/delete in the process goes through these, so --allocs can
+// report how many heap allocations a turn makes once a match has warmed up.
+static std::atomic<long long> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static constexpr int ALLOC_WARMUP_TURNS = 100; // buffers grow to size during the opening turns
+
+static std::vector<std::unique_ptr<ShipBase>> MakeRoster(const std::vector<std::string>& names) {
+    std::vector<std::unique_ptr<ShipBase>> v;
+    if (names.empty()) {
+        for (const auto& e : AstroShipRoster()) v.emplace_back(e.make());
+    } else {
+        for (const auto& n : names) v.emplace_back(MakeAstroShip(n));
+    }
+    return v;
+}
+
+static std::vector<std::string> SplitNames(const char* list) {
+    std::vector<std::string> out;
+    std::string cur;
+    for (const char* p = list; ; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!cur.empty()) out.push_back(cur);
+            cur.clear();
+            if (*p == '\0') break;
+        } else {
+            cur += *p;
+        }
+    }
+    return out;
+}
+
+static void PrintUsage() {
+    std::printf("usage: astro_sim [--matches N] [--seed S] [--log] [--record FILE] [--compiled] [--batched]\n");
+    std::printf("                 [--simultaneous [--script-threads T]] [--allocs] [--effects [--particle-cap N]]\n");
+    std::printf("       astro_sim --replay FILE [--log]\n");
+    std::printf("       astro_sim --fork TURN [--seed S] [--ships A,B,...]\n");
+    std::printf("       astro_sim --sim-thread [--seed S] [--ships A,B,...]\n");
+    std::printf("       astro_sim --vm-bench COPIES [--seed S]\n");
+    std::printf("       astro_sim --fx-bench PARTICLES [--seed S]\n");
+    std::printf("       astro_sim --spawn-bench ASTEROIDS [--seed S]\n");
+    std::printf("       astro_sim --scan-bench OBJECTS [--seed S]\n");
+    std::printf("       astro_sim --vm-diff [--matches N] [--seed S] [--ships A,B,...]\n");
+    std::printf("       astro_sim --tournament [--ships A,B,...] [--per-match K] [--rounds N] [--seed S] [--threads T] [--verbose]\n");
+    std::printf("  --matches N     number of matches to play (default 1)\n");
+    std::printf("  --seed S        base seed (default 1); match i uses S+i, tournaments print each match seed\n");
+    std::printf("  --log           print the arena log while playing\n");
+    std::printf("  --record FILE   write a binary replay of the first match\n");
+    std::printf("  --replay FILE   re-simulate a recorded match and verify it turn by turn\n");
+    std::printf("  --fork TURN     snapshot a match at TURN, finish it from the snapshot and time save/restore\n");
+    std::printf("  --sim-thread    play a match on the viewer's simulation thread (turbo, then fast-forward) and check the result\n");
+    std::printf("  --vm-bench N    time the switch and computed goto VM backends with N of each sample ship\n");
+    std::printf("  --fx-bench N    time the SIMD and scalar particle/debris integrators on N particles\n");
+    std::printf("  --spawn-bench N time breaking N large asteroids down to smalls, library shapes vs generated hulls\n");
+    std::printf("  --scan-bench N  time scans among N ships and asteroids, grid search vs linear pass, and compare them\n");
+    std::printf("  --compiled      run ship scripts as compiled closures instead of the interpreter\n");
+    std::printf("  --batched       run all ship scripts in lockstep, weapons resolving after every script\n");
+    std::printf("  --simultaneous  two-phase turns: scripts record intents, weapons resolve together\n");
+    std::printf("  --script-threads T  run each turn's scripts on T threads (needs --simultaneous)\n");
+    std::printf("  --allocs        count heap allocations per turn after the first %d turns; fail if any\n", ALLOC_WARMUP_TURNS);
+    std::printf("  --effects       also turn each turn's events into particles and debris, as the viewer does\n");
+    std::printf("  --particle-cap N  particle pool size for --effects; bursts beyond it are dropped and counted\n");
+    std::printf("  --vm-diff       play each match with the interpreter and compiled scripts in lockstep and compare\n");
+    std::printf("  --tournament    round-robin over the roster on a thread pool\n");
+    std::printf("  --ships A,B     ships to enter (default: whole roster)\n");
+    std::printf("  --per-match K   ships per match (default: all entered ships)\n");
+    std::printf("  --rounds N      matches per fixture (default 1)\n");
+    std::printf("  --threads T     worker threads (default: hardware threads)\n");
+    std::printf("  --verbose       list every tournament match with the seed to replay it\n");
+    std::printf("ships:");
+    for (const auto& e : AstroShipRoster()) std::printf(" %s", e.name.c_str());
+    std::printf("\n");
+}
+
+static int RunReplay(const std::string& path, bool printLog) {
+    AstroReplayReader replay;
+    std::string error;
+    if (!replay.LoadFile(path, error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    AstroMatch match;
+    if (printLog) {
+        match.arena.log = [](const std::string& line) { std::cout << line << "\n"; };
+    }
+    if (!AstroReplaySeek(replay, replay.LastTurn(), match, error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    int winner = match.Winner();
+    std::printf("replay verified: %d turns, seed %llu, %s\n", replay.LastTurn(), (unsigned long long)replay.seed,
+                winner >= 0 ? (match.ships[winner]->name + " wins").c_str() : "no winner");
+    return 0;
+}
+
+// Snapshot a match mid-game, play the original and a restored copy to the end
+// and check they finish in the same state
+static int RunFork(const std::vector<std::string>& roster, uint64_t seed, int forkTurn) {
+    AstroMatch original;
+    original.Setup(MakeRoster(roster), seed);
+    while (original.turn < forkTurn && original.Step()) {}
+
+    std::vector<uint8_t> snapshot;
+    AstroSaveSnapshot(original, snapshot);
+    AstroMatch fork;
+    std::string error;
+    if (!AstroLoadSnapshot(snapshot, fork, error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+
+    // time repeated forks into the same match, the way a search would use them
+    const int reps = 1000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) AstroSaveSnapshot(original, snapshot);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i) AstroLoadSnapshot(snapshot, fork, error);
+    auto t2 = std::chrono::steady_clock::now();
+    double saveUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+    double loadUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / reps;
+
+    int at = original.turn;
+    while (original.Step()) {}
+    while (fork.Step()) {}
+    std::vector<uint8_t> a, b;
+    AstroSaveSnapshot(original, a);
+    AstroSaveSnapshot(fork, b);
+    std::printf("forked at turn %d: %zu byte snapshot, save %.1f us, restore %.1f us\n", at, snapshot.size(), saveUs, loadUs);
+    if (a != b) {
+        std::printf("fork diverged: original ended on turn %d, fork on turn %d\n", original.turn, fork.turn);
+        return 1;
+    }
+    std::printf("fork matches the original through turn %d\n", original.turn);
+    return 0;
+}
+
+// Play a match on an AstroSimThread the way the viewer runs it, once in turbo
+// and once as a fast-forward to the end, while this thread keeps acquiring
+// frames; check every frame is whole and newer than the last, and that the
+// match ends exactly as a plain AstroMatch does
+static int RunSimThread(const std::vector<std::string>& roster, uint64_t seed) {
+    AstroMatch direct;
+    direct.Setup(MakeRoster(roster), seed);
+    while (direct.Step()) {}
+    std::vector<uint8_t> expected, actual;
+    AstroSaveSnapshot(direct, expected);
+
+    AstroClock clock;
+    clock.turbo = true;
+    clock.frameBudgetMs = 1.0;
+    int failures = 0;
+    for (int fastForward = 0; fastForward < 2; ++fastForward) {
+        AstroSimThread sim;
+        sim.SetClock(clock);
+        auto t0 = std::chrono::steady_clock::now();
+        sim.Start(MakeRoster(roster), seed);
+        if (fastForward) sim.FastForward(0);
+
+        long long frames = 0, progressFrames = 0, torn = 0;
+        uint64_t serial = 0;
+        int turn = 0;
+        while (true) {
+            const AstroRenderFrame& f = sim.Acquire();
+            if (f.serial == serial) {
+                std::this_thread::yield();
+                continue;
+            }
+            ++frames;
+            if (f.fastForwarding) ++progressFrames;
+            if (f.serial < serial || f.turn < turn || f.ships.size() != f.shipNames.size() ||
+                f.prevShips.size() != f.ships.size()) {
+                ++torn;
+            }
+            serial = f.serial;
+            turn = f.turn;
+            if (!f.running && !f.fastForwarding && f.turn > 0) break;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        sim.Call([&] { AstroSaveSnapshot(sim.match, actual); });
+
+        std::printf("%-12s %d turns in %.3f s (%.0f turns/s), %lld frames read (%lld progress)\n",
+                    fastForward ? "fast-forward" : "turbo", turn, secs, secs > 0.0 ? turn / secs : 0.0,
+                    frames, progressFrames);
+        if (torn > 0) {
+            std::printf("%lld frames were inconsistent\n", torn);
+            ++failures;
+        }
+        if (actual != expected) {
+            std::printf("threaded match diverged: ended on turn %d, expected turn %d\n", turn, direct.turn);
+            ++failures;
+        }
+    }
+    if (failures) return 1;
+    std::printf("threaded matches match a direct run through turn %d\n", direct.turn);
+    return 0;
+}
+
+// Time both VM dispatch backends on the sample ships. The arena holds `copies`
+// of every roster ship; each backend starts from the same snapshot and plays
+// the same script turns, and must leave the arena in the same state.
+static int RunVmBench(int copies, uint64_t seed) {
+    std::vector<std::string> names;
+    for (int c = 0; c < copies; ++c) {
+        for (const auto& e : AstroShipRoster()) names.push_back(e.name);
+    }
+    AstroMatch match;
+    match.Setup(MakeRoster(names), seed);
+    for (int t = 0; t < 30 && match.Step(); ++t) {} // let scans find targets and cooldowns spread
+    std::vector<uint8_t> start;
+    AstroSaveSnapshot(match, start);
+
+    struct Backend { const char* name; void (ShipBase::*run)(); };
+    const Backend backends[] = { { "switch", &ShipBase::RunSwitch }, { "computed goto", &ShipBase::RunComputedGoto } };
+    const int turns = 200;
+    std::string error;
+    std::printf("%d ships, %d script turns each%s\n", (int)names.size(), turns,
+                ASTRO_VM_HAS_COMPUTED_GOTO ? "" : " (no computed goto on this compiler, both rows use the switch)");
+    std::printf("%-12s %14s %14s %8s\n", "ship", "switch ns/run", "goto ns/run", "speedup");
+    for (const auto& e : AstroShipRoster()) {
+        double ns[2] = { 0.0, 0.0 };
+        std::vector<uint8_t> end[2];
+        // interleave three passes per backend and keep the fastest to damp noise
+        for (int pass = 0; pass < 6; ++pass) {
+            int b = pass % 2;
+            AstroLoadSnapshot(start, match, error);
+            double secs = 0.0;
+            long long runs = 0;
+            for (int t = 0; t < turns; ++t) {
+                match.arena.StartTurn();
+                auto t0 = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < match.ships.size(); ++i) {
+                    if (!match.arena.ships[i].alive || match.ships[i]->name != e.name) continue;
+                    (match.ships[i].get()->*backends[b].run)();
+                    runs++;
+                }
+                secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            }
+            double perRun = runs ? secs * 1e9 / runs : 0.0;
+            if (pass < 2 || perRun < ns[b]) ns[b] = perRun;
+            AstroSaveSnapshot(match, end[b]);
+        }
+        if (end[0] != end[1]) {
+            std::printf("%-12s backends disagree\n", e.name.c_str());
+            return 1;
+        }
+        std::printf("%-12s %14.1f %14.1f %7.2fx\n", e.name.c_str(), ns[0], ns[1], ns[1] > 0.0 ? ns[0] / ns[1] : 0.0);
+    }
+    std::printf("this build dispatches with %s\n", backends[ASTRO_VM_USES_COMPUTED_GOTO ? 1 : 0].name);
+
+    // whole roster per turn: one ship at a time vs the lockstep batch (which
+    // defers weapon fire, so its arena state is not expected to match)
+    double perShip[2] = { 0.0, 0.0 };
+    for (int pass = 0; pass < 6; ++pass) {
+        int b = pass % 2;
+        AstroLoadSnapshot(start, match, error);
+        double secs = 0.0;
+        long long runs = 0;
+        for (int t = 0; t < turns; ++t) {
+            match.arena.StartTurn();
+            auto t0 = std::chrono::steady_clock::now();
+            if (b == 1) {
+                match.batch.Run(match.arena, match.ships);
+            } else {
+                for (size_t i = 0; i < match.ships.size(); ++i) {
+                    if (match.arena.ships[i].alive) match.ships[i]->Run(t);
+                }
+            }
+            secs += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            runs += match.AliveCount();
+        }
+        double ns = runs ? secs * 1e9 / runs : 0.0;
+        if (pass < 2 || ns < perShip[b]) perShip[b] = ns;
+    }
+    std::printf("all ships: %.1f ns/run one at a time, %.1f ns/run batched (%zu groups)\n",
+                perShip[0], perShip[1], match.batch.GroupCount());
+    return 0;
+}
+
+// Time the effect integrators: the same particle and debris pools are
+// advanced with Update() and UpdateScalar(), which must agree bit for bit.
+static int RunFxBench(size_t count, uint64_t seed) {
+    AstroRng rng;
+    rng.Seed(seed, ASTRO_RNG_PARTICLES);
+    AstroParticles particles;
+    AstroDebris debris;
+    particles.SetCapacity(count);
+    debris.Reserve(count / 8);
+    for (size_t i = 0; i < count; ++i) {
+        Particle p;
+        float a = rng.Uniform(0.0f, 2.0f * (float)M_PI);
+        float s = rng.Uniform(PARTICLE_MIN_SPEED, PARTICLE_MAX_SPEED) * 2.0f;
+        p.x = rng.Uniform(0.0f, ASTROBOTS_W); p.y = rng.Uniform(0.0f, ASTROBOTS_H);
+        p.vx = std::cos(a) * s; p.vy = std::sin(a) * s;
+        p.lifetime = p.startLifetime = rng.Range(10, 400);
+        p.length = PARTICLE_LENGTH;
+        p.color = ASTRO_COL32(255, 200, 140, 255);
+        p.alive = true;
+        particles.Push(p);
+    }
+    for (size_t i = 0; i < count / 8; ++i) {
+        ShipDebrisSegment d;
+        d.x1 = rng.Uniform(0.0f, ASTROBOTS_W); d.y1 = rng.Uniform(0.0f, ASTROBOTS_H);
+        d.x2 = d.x1 + rng.Uniform(-8.0f, 8.0f); d.y2 = d.y1 + rng.Uniform(-8.0f, 8.0f);
+        d.vx = rng.Uniform(-1.8f, 1.8f); d.vy = rng.Uniform(-1.8f, 1.8f);
+        d.angVel = (i % 4 == 0) ? 0.0f : rng.Uniform(-0.05f, 0.05f);
+        d.lifetime = d.startLifetime = rng.Range(10, 400);
+        d.color = ASTRO_COL32(120, 200, 255, 255);
+        d.alive = true;
+        debris.Push(d);
+    }
+
+    const int turns = 100;
+    AstroParticles p[2];
+    AstroDebris d[2];
+    double ns[2] = { 0.0, 0.0 };
+    long long steps[2] = { 0, 0 };
+    // interleave three passes per path and keep the fastest to damp noise
+    for (int pass = 0; pass < 6; ++pass) {
+        int b = pass % 2;
+        p[b] = particles;
+        d[b] = debris;
+        long long n = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int t = 0; t < turns; ++t) {
+            n += (long long)(p[b].Size() + d[b].Size());
+            if (b == 0) { p[b].Update(true); d[b].Update(); }
+            else { p[b].UpdateScalar(true); d[b].UpdateScalar(); }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        double perStep = n ? secs * 1e9 / n : 0.0;
+        if (pass < 2 || perStep < ns[b]) ns[b] = perStep;
+        steps[b] = n;
+    }
+
+    bool same = steps[0] == steps[1] && p[0].Size() == p[1].Size() && d[0].Size() == d[1].Size();
+    for (size_t i = 0; same && i < p[0].Size(); ++i) {
+        Particle a = p[0].Get(i), b = p[1].Get(i);
+        same = std::memcmp(&a.x, &b.x, 4) == 0 && std::memcmp(&a.y, &b.y, 4) == 0 &&
+               std::memcmp(&a.vx, &b.vx, 4) == 0 && std::memcmp(&a.vy, &b.vy, 4) == 0 && a.lifetime == b.lifetime;
+    }
+    for (size_t i = 0; same && i < d[0].Size(); ++i) {
+        ShipDebrisSegment a = d[0].Get(i), b = d[1].Get(i);
+        same = std::memcmp(&a.x1, &b.x1, 6 * sizeof(float)) == 0 && a.lifetime == b.lifetime;
+    }
+    std::printf("%zu particles, %zu debris segments, %d turns (%zu + %zu left)\n",
+                count, count / 8, turns, p[0].Size(), d[0].Size());
+    std::printf("%-8s %10.2f ns/entity-turn\n", ASTRO_FX_SIMD_NAME, ns[0]);
+    std::printf("%-8s %10.2f ns/entity-turn\n", "scalar", ns[1]);
+    std::printf("speedup  %9.2fx\n", ns[0] > 0.0 ? ns[1] / ns[0] : 0.0);
+    if (!same) {
+        std::printf("SIMD and scalar integrators disagree\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Mass-break cost: spawn `count` large asteroids and break everything down to
+// smalls, as a run of hits does. Path 0 is the arena as is (shape picked from
+// the library); path 1 additionally generates a hull for every fragment, which
+// is what each spawn used to cost.
+static int RunSpawnBench(int count, uint64_t seed) {
+    static const int sides[ASTRO_ASTEROID_CLASSES] = { 8, 7, 6 };
+    AstroArena arena;
+    arena.asteroids.reserve((size_t)count * 16);
+    AstroRng hullRng;
+    size_t hullVerts = 0; // reported, so the generated hulls are not optimised away
+    double ns[2] = { 0.0, 0.0 };
+    size_t fragments = 0;
+    // interleave three passes per path and keep the fastest to damp noise
+    for (int pass = 0; pass < 6; ++pass) {
+        int b = pass % 2;
+        arena.asteroids.clear();
+        arena.Seed(seed);
+        hullRng.Seed(seed, ASTRO_RNG_SHAPES);
+        auto t0 = std::chrono::steady_clock::now();
+        arena.SpawnAsteroids(count);
+        for (size_t i = 0; i < arena.asteroids.size(); ++i) {
+            size_t first = arena.asteroids.size();
+            arena.BreakAsteroid((int)i);
+            for (size_t f = first; b == 1 && f < arena.asteroids.size(); ++f) {
+                const Asteroid& a = arena.asteroids[f];
+                c2Poly hull = AstroMakeAsteroidPoly(sides[a.shape / ASTRO_ASTEROID_SHAPES_PER_CLASS], a.size, hullRng);
+                hullVerts += (size_t)hull.count;
+            }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        fragments = arena.asteroids.size();
+        double perSpawn = secs * 1e9 / (double)fragments;
+        if (pass < 2 || perSpawn < ns[b]) ns[b] = perSpawn;
+    }
+    std::printf("%d large asteroids broken into %zu spawns (%zu shapes in the library)\n",
+                count, fragments, AstroAsteroidShapes().size());
+    std::printf("%-10s %10.2f ns/spawn\n", "library", ns[0]);
+    std::printf("%-10s %10.2f ns/spawn (%zu hull vertices)\n", "generated", ns[1], hullVerts / 3);
+    std::printf("speedup    %9.2fx\n", ns[0] > 0.0 ? ns[1] / ns[0] : 0.0);
+    return 0;
+}
+
+// Scan queries in a crowded arena: `count` objects, one ship in eight, spread
+// over the whole arena including the wrap seams. Path 0 is the grid's ring
+// search, path 1 the linear pass it must agree with exactly. Some objects are
+// dead, some ships share a position and some sit on cell corners, so the
+// tie-breaks and cell edges get exercised too.
+static int RunScanBench(int count, uint64_t seed) {
+    AstroArena arena;
+    AstroRng rng;
+    rng.Seed(seed, ASTRO_RNG_ASTEROIDS);
+    int shipCount = std::max(count / 8, 2);
+    const int rounds = 8;
+    double ns[2] = { 0.0, 0.0 };
+    long long scans = 0, hits = 0;
+    std::vector<AstroArena::ShipState> grid;
+    for (int round = 0; round < rounds; ++round) {
+        arena.Seed(seed + (uint64_t)round);
+        arena.asteroids.clear();
+        arena.SpawnAsteroids(std::max(count - shipCount, 0));
+        for (size_t i = 0; i < arena.asteroids.size(); ++i) {
+            Asteroid& a = arena.asteroids[i];
+            a.x = rng.Uniform(0.0f, ASTROBOTS_W);
+            a.y = rng.Uniform(0.0f, ASTROBOTS_H);
+            a.alive = i % 5 != 4;
+        }
+        arena.ships.assign((size_t)shipCount, AstroArena::ShipState{});
+        for (int i = 0; i < shipCount; ++i) {
+            auto& s = arena.ships[i];
+            s.x = rng.Uniform(0.0f, ASTROBOTS_W);
+            s.y = rng.Uniform(0.0f, ASTROBOTS_H);
+            if (i % 9 == 3) {
+                int cs = arena.gridCellSize;
+                s.x = (float)(rng.Range(0, (int)ASTROBOTS_W / cs - 1) * cs);
+                s.y = (float)(rng.Range(0, (int)ASTROBOTS_H / cs - 1) * cs);
+            }
+            if (i % 16 == 15) { s.x = arena.ships[i - 1].x; s.y = arena.ships[i - 1].y; }
+            s.alive = i % 7 != 6;
+        }
+        arena.spatialDirty = true;
+        arena.RefreshBroadphase();
+
+        for (int b = 0; b < 2; ++b) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < shipCount; ++i) arena.Scan(i, b == 1);
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            ns[b] += secs * 1e9;
+            if (b == 0) grid = arena.ships;
+        }
+        for (int i = 0; i < shipCount; ++i) {
+            const auto& g = grid[i];
+            const auto& l = arena.ships[i];
+            if (g.scan_hit != l.scan_hit || std::memcmp(&g.scan_dist, &l.scan_dist, 4) != 0 ||
+                std::memcmp(&g.scan_angle, &l.scan_angle, 4) != 0) {
+                std::printf("round %d, ship %d at (%.2f, %.2f): grid scan hit=%d dist=%.4f angle=%.4f, "
+                            "linear hit=%d dist=%.4f angle=%.4f\n", round, i, l.x, l.y,
+                            (int)g.scan_hit, g.scan_dist, g.scan_angle, (int)l.scan_hit, l.scan_dist, l.scan_angle);
+                return 1;
+            }
+            if (l.alive) {
+                scans++;
+                hits += l.scan_hit ? 1 : 0;
+            }
+        }
+    }
+    std::printf("%d ships and %d asteroids, %d rounds: %lld scans, %lld hits\n",
+                shipCount, std::max(count - shipCount, 0), rounds, scans, hits);
+    std::printf("%-8s %10.1f ns/scan\n", "grid", scans ? ns[0] / scans : 0.0);
+    std::printf("%-8s %10.1f ns/scan\n", "linear", scans ? ns[1] / scans : 0.0);
+    std::printf("speedup  %9.2fx\n", ns[0] > 0.0 ? ns[1] / ns[0] : 0.0);
+    std::printf("grid and linear scans agree\n");
+    return 0;
+}
+
+// Differential check of compiled scripts against the interpreter: play every
+// match twice in lockstep and compare full snapshots after each turn
+static int RunVmDiff(const std::vector<std::string>& roster, uint64_t seed, int matches) {
+    long long totalTurns = 0;
+    std::vector<uint8_t> a, b;
+    for (int m = 0; m < matches; ++m) {
+        AstroMatch interpreted, compiled;
+        compiled.compiledScripts = true;
+        interpreted.Setup(MakeRoster(roster), seed + (uint64_t)m);
+        compiled.Setup(MakeRoster(roster), seed + (uint64_t)m);
+        do {
+            AstroSaveSnapshot(interpreted, a);
+            AstroSaveSnapshot(compiled, b);
+            if (a != b) {
+                std::printf("match %d (seed %llu): compiled scripts diverged on turn %d\n",
+                            m, (unsigned long long)(seed + (uint64_t)m), interpreted.turn);
+                return 1;
+            }
+            compiled.Step();
+        } while (interpreted.Step());
+        totalTurns += interpreted.turn;
+    }
+    std::printf("compiled scripts match the interpreter: %d matches, %lld turns\n", matches, totalTurns);
+    return 0;
+}
+
+static int RunTournament(const AstroTournamentConfig& config, bool verbose) {
+    AstroTournamentResult result;
+    std::string error;
+    if (!RunAstroTournament(config, result, error)) {
+        std::fprintf(stderr, "astro_sim: %s\n", error.c_str());
+        return 1;
+    }
+    if (verbose) {
+        for (size_t i = 0; i < result.matches.size(); ++i) {
+            const auto& r = result.matches[i];
+            std::string names;
+            for (int e : r.entrants) names += (names.empty() ? "" : ",") + result.ships[e].name;
+            const char* outcome = r.winner >= 0 ? result.ships[r.winner].name.c_str() : (r.draw ? "draw" : "none");
+            std::printf("match %zu: --seed %llu --ships %s -> %s on turn %d\n",
+                        i, (unsigned long long)r.seed, names.c_str(), outcome, r.turns);
+        }
+    }
+    std::printf("%-12s %7s %6s %6s %7s %8s %12s\n", "ship", "played", "wins", "draws", "losses", "win%", "avg survival");
+    for (const auto& st : result.ships) {
+        double winPct = st.played ? 100.0 * st.wins / st.played : 0.0;
+        double avgSurvival = st.played ? (double)st.survivedTurns / st.played : 0.0;
+        std::printf("%-12s %7d %6d %6d %7d %7.1f%% %12.1f\n",
+                    st.name.c_str(), st.played, st.wins, st.draws, st.losses, winPct, avgSurvival);
+    }
+    std::printf("%d matches, %lld turns in %.3f s on %d threads (%.0f turns/s)\n",
+                (int)result.matches.size(), result.totalTurns, result.seconds, result.threads,
+                result.seconds > 0.0 ? result.totalTurns / result.seconds : 0.0);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int matches = 1;
+    bool printLog = false;
+    bool tournament = false;
+    bool verbose = false;
+    std::string recordPath;
+    std::string replayPath;
+    int forkTurn = -1;
+    bool simThread = false;
+    int vmBenchCopies = 0;
+    size_t fxBenchCount = 0;
+    int spawnBenchCount = 0;
+    int scanBenchCount = 0;
+    bool vmDiff = false;
+    bool countAllocs = false;
+    bool withEffects = false;
+    size_t particleCap = 0;
+    int scriptThreads = 1;
+    AstroTournamentConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matches = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--log") == 0) {
+            printLog = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fork") == 0 && i + 1 < argc) {
+            forkTurn = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--sim-thread") == 0) {
+            simThread = true;
+        } else if (std::strcmp(argv[i], "--vm-bench") == 0 && i + 1 < argc) {
+            vmBenchCopies = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--fx-bench") == 0 && i + 1 < argc) {
+            fxBenchCount = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--spawn-bench") == 0 && i + 1 < argc) {
+            spawnBenchCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scan-bench") == 0 && i + 1 < argc) {
+            scanBenchCount = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--vm-diff") == 0) {
+            vmDiff = true;
+        } else if (std::strcmp(argv[i], "--compiled") == 0) {
+            config.compiledScripts = true;
+        } else if (std::strcmp(argv[i], "--batched") == 0) {
+            config.batchedScripts = true;
+        } else if (std::strcmp(argv[i], "--simultaneous") == 0) {
+            config.simultaneousTurns = true;
+        } else if (std::strcmp(argv[i], "--script-threads") == 0 && i + 1 < argc) {
+            scriptThreads = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--particle-cap") == 0 && i + 1 < argc) {
+            particleCap = (size_t)std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--effects") == 0) {
+            withEffects = true;
+        } else if (std::strcmp(argv[i], "--allocs") == 0) {
+            countAllocs = true;
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else if (std::strcmp(argv[i], "--tournament") == 0) {
+            tournament = true;
+        } else if (std::strcmp(argv[i], "--ships") == 0 && i + 1 < argc) {
+            config.roster = SplitNames(argv[++i]);
+        } else if (std::strcmp(argv[i], "--per-match") == 0 && i + 1 < argc) {
+            config.shipsPerMatch = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+            config.rounds = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = std::atoi(argv[++i]);
+        } else {
+            PrintUsage();
+            return (std::strcmp(argv[i], "--help") == 0) ? 0 : 1;
+        }
+    }
+    for (const auto& n : config.roster) {
+        if (!MakeAstroShip(n)) {
+            std::fprintf(stderr, "astro_sim: unknown ship '%s'\n", n.c_str());
+            return 1;
+        }
+    }
+    if (!replayPath.empty()) return RunReplay(replayPath, printLog);
+    if (matches < 1) matches = 1;
+    if (vmDiff) return RunVmDiff(config.roster, config.seed, matches);
+    if (vmBenchCopies > 0) return RunVmBench(vmBenchCopies, config.seed);
+    if (fxBenchCount > 0) return RunFxBench(fxBenchCount, config.seed);
+    if (spawnBenchCount > 0) return RunSpawnBench(spawnBenchCount, config.seed);
+    if (scanBenchCount > 0) return RunScanBench(scanBenchCount, config.seed);
+    if (forkTurn >= 0) return RunFork(config.roster, config.seed, forkTurn);
+    if (simThread) return RunSimThread(config.roster, config.seed);
+    if (tournament) return RunTournament(config, verbose);
+
+    long long totalTurns = 0;
+    long long steadyTurns = 0, steadyAllocs = 0, allocatingTurns = 0;
+    unsigned long long droppedParticles = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int m = 0; m < matches; ++m) {
+        AstroMatch match;
+        match.compiledScripts = config.compiledScripts;
+        match.batchedScripts = config.batchedScripts;
+        match.simultaneousTurns = config.simultaneousTurns;
+        match.scriptThreads = config.simultaneousTurns ? scriptThreads : 1;
+        match.arena.recordEvents = withEffects;
+        if (printLog) {
+            match.arena.log = [](const std::string& line) { std::cout << line << "\n"; };
+        }
+        match.Setup(MakeRoster(config.roster), config.seed + (uint64_t)m);
+        // headless runs normally skip effects entirely; --effects measures what a renderer adds
+        AstroEffects effects;
+        effects.particleCapacity = particleCap;
+        if (withEffects) effects.Reset(match.arena.matchSeed, match.ships.size());
+        auto step = [&] {
+            bool more = match.Step();
+            if (withEffects && match.turn <= ASTRO_MAX_TURNS) {
+                effects.Update();
+                effects.Apply(match.arena);
+            }
+            return more;
+        };
+
+        if (m == 0 && !recordPath.empty()) {
+            std::ofstream out(recordPath, std::ios::binary);
+            if (!out) {
+                std::fprintf(stderr, "astro_sim: cannot write %s\n", recordPath.c_str());
+                return 1;
+            }
+            std::vector<std::string> names;
+            for (const auto& s : match.ships) names.push_back(s->name);
+            AstroReplayWriter writer;
+            writer.Begin(match, names, &out);
+            while (match.running) {
+                step();
+                writer.RecordTurn(match);
+            }
+            writer.Flush();
+            std::printf("recorded %d turns to %s (%zu bytes, %.1f bytes/turn)\n", writer.LastTurn(), recordPath.c_str(),
+                        writer.Size(), writer.LastTurn() > 0 ? (double)writer.Size() / writer.LastTurn() : 0.0);
+        }
+        if (countAllocs) {
+            while (true) {
+                long long before = g_allocations.load(std::memory_order_relaxed);
+                bool more = step();
+                long long made = g_allocations.load(std::memory_order_relaxed) - before;
+                if (match.turn > ALLOC_WARMUP_TURNS && match.turn <= ASTRO_MAX_TURNS) {
+                    steadyTurns++;
+                    steadyAllocs += made;
+                    allocatingTurns += made > 0 ? 1 : 0;
+                }
+                if (!more) break;
+            }
+        } else {
+            while (step()) {}
+        }
+
+        totalTurns += match.turn;
+        droppedParticles += effects.particles.dropped;
+        int winner = match.Winner();
+        if (winner >= 0) {
+            std::printf("match %d (seed %llu): %s wins on turn %d\n", m, (unsigned long long)match.arena.matchSeed,
+                        match.ships[winner]->name.c_str(), match.turn);
+        } else if (match.IsDraw()) {
+            std::printf("match %d (seed %llu): draw after %d turns (%d alive)\n", m, (unsigned long long)match.arena.matchSeed,
+                        ASTRO_MAX_TURNS, match.AliveCount());
+        } else {
+            std::printf("match %d (seed %llu): no survivors on turn %d\n", m, (unsigned long long)match.arena.matchSeed, match.turn);
+        }
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%d matches, %lld turns in %.3f s (%.0f turns/s)\n",
+                matches, totalTurns, secs, secs > 0.0 ? totalTurns / secs : 0.0);
+    if (droppedParticles > 0) std::printf("particle pool full: %llu spawns dropped\n", droppedParticles);
+    if (countAllocs) {
+        std::printf("allocations after turn %d: %lld in %lld turns (%.3f per turn, %lld turns allocated)\n",
+                    ALLOC_WARMUP_TURNS, steadyAllocs, steadyTurns,
+                    steadyTurns > 0 ? (double)steadyAllocs / steadyTurns : 0.0, allocatingTurns);
+        // a warmed-up turn is expected not to touch the heap
+        if (steadyAllocs > 0) return 1;
+    }
+    return 0;
+}
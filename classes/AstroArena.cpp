@@ -1,20 +1,16 @@
-#include "../imgui/imgui.h"
 #include <iostream>
 #include "AstroTypes.h"
 #include "AstroArena.h"
-#include "AstroBots.h"
-#include <random>
+#include "AstroShip.h"
 #include <algorithm>
+#include <bit>
 #include <cmath> 
+#include <limits>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// RNG for arena systems
-static std::random_device rd_arena;
-static std::mt19937 rng(rd_arena());
-
 // ===== Helper functions (arena-local) =====
 static float NormalizeAngle(float angle) {
     while (angle < 0) angle += 360.0f;
@@ -32,6 +28,16 @@ static float Distance(float x1, float y1, float x2, float y2) {
     float dy = y2 - y1;
     return std::sqrt(dx*dx + dy*dy);
 }
+// shortest signed offset along one axis of the torus
+static float WrapDelta(float d, float size) {
+    if (d > size * 0.5f) d -= size;
+    else if (d < -size * 0.5f) d += size;
+    return d;
+}
+// floor(a / b) for b > 0
+static int FloorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
 static float AngleTo(float x1, float y1, float x2, float y2) {
     float dx = x2 - x1;
     float dy = y2 - y1;
@@ -39,6 +45,17 @@ static float AngleTo(float x1, float y1, float x2, float y2) {
 }
 
 // ===== cute_c2 helpers for ship/torpedo shapes =====
+// farthest any collider reaches from its centre: the widest hull in the
+// asteroid shape library, or a ship capsule (22.5)
+static float MaxColliderExtent() {
+    static const float extent = [] {
+        float r = 22.5f;
+        for (const auto& shape : AstroAsteroidShapes()) r = std::max(r, shape.radius);
+        return r;
+    }();
+    return extent;
+}
+
 static c2Capsule MakeShipCapsule(const AstroArena::ShipState& s) {
     const float halfLen = 15.0f;
     const float radius = 7.5f;
@@ -65,45 +82,133 @@ static c2Circle MakeTorpedoCircle(const PhotonTorpedo& t) {
     return c;
 }
 
-static void BuildWrapTransforms(float x, float y, std::array<c2x, 9>& out_tr, int& out_count) {
-    out_count = 0;
-    for (int oy = -1; oy <= 1; ++oy) {
-        for (int ox = -1; ox <= 1; ++ox) {
-            c2x tr = c2xIdentity();
-            tr.p = c2V(x + ox * ASTROBOTS_W, y + oy * ASTROBOTS_H);
-            out_tr[out_count++] = tr;
-        }
+// ===== Torus image selection =====
+// The narrowphase only needs the wrap images of an object whose bounding box
+// overlaps the probe's. Along each axis that is normally just the nearest
+// image, plus the neighbour across the seam when the object straddles it, and
+// none at all when the boxes are apart. Images stay within one arena of the
+// original, as the full 3x3 sweep did, and come out in the same row-major order.
+struct WrapImages {
+    c2v off[9];
+    int count = 0;
+};
+static void AxisImages(float objLo, float objHi, float lo, float hi, float size, int& kLo, int& kHi) {
+    const float slack = 1.0f; // for rounding in the narrowphase
+    kLo = std::max(-1, (int)std::ceil((lo - slack - objHi) / size));
+    kHi = std::min(1, (int)std::floor((hi + slack - objLo) / size));
+}
+static void SelectWrapImages(const c2AABB& obj, const c2AABB& probe, WrapImages& out) {
+    int xLo, xHi, yLo, yHi;
+    AxisImages(obj.min.x, obj.max.x, probe.min.x, probe.max.x, ASTROBOTS_W, xLo, xHi);
+    AxisImages(obj.min.y, obj.max.y, probe.min.y, probe.max.y, ASTROBOTS_H, yLo, yHi);
+    out.count = 0;
+    for (int ky = yLo; ky <= yHi; ++ky) {
+        for (int kx = xLo; kx <= xHi; ++kx) out.off[out.count++] = c2V(kx * ASTROBOTS_W, ky * ASTROBOTS_H);
     }
 }
+static c2AABB BoxAround(float x1, float y1, float x2, float y2, float r) {
+    c2AABB box;
+    box.min = c2V(std::min(x1, x2) - r, std::min(y1, y2) - r);
+    box.max = c2V(std::max(x1, x2) + r, std::max(y1, y2) + r);
+    return box;
+}
 
 // ===== Broad-phase uniform grid =====
+// Counting sort of the live objects into cells: count per cell, prefix-sum into
+// start offsets, then scatter indices in ascending order
+template <class T>
+static void BinObjects(const AstroArena& arena, const std::vector<T>& objs, std::vector<int>& cellOf,
+                       std::vector<int>& start, std::vector<int>& items) {
+    int cells = arena.gridCols * arena.gridRows;
+    start.assign(cells + 1, 0);
+    cellOf.resize(objs.size());
+    for (size_t i = 0; i < objs.size(); ++i) {
+        cellOf[i] = -1;
+        if (!objs[i].alive) continue;
+        int cx, cy; arena.PosToCell(objs[i].x, objs[i].y, cx, cy);
+        cellOf[i] = arena.CellIndex(cx, cy);
+        if (cellOf[i] >= 0) start[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cells; ++c) start[c + 1] += start[c];
+    items.resize(start[cells]);
+    // start[c] is used as the write cursor and shifted back afterwards
+    for (size_t i = 0; i < objs.size(); ++i) {
+        if (cellOf[i] >= 0) items[start[cellOf[i]]++] = (int)i;
+    }
+    for (int c = cells; c > 0; --c) start[c] = start[c - 1];
+    start[0] = 0;
+}
+
+// which cells hold a ship or an asteroid, so sparse scans can skip empty rows and cells
+static void BuildRowMasks(AstroArena& arena) {
+    arena.gridRowMask.assign((size_t)arena.gridRows, 0);
+    int cols = std::min(arena.gridCols, 64);
+    for (int y = 0; y < arena.gridRows; ++y) {
+        uint64_t mask = 0;
+        for (int x = 0; x < cols; ++x) {
+            int c = y * arena.gridCols + x;
+            bool any = arena.gridShipStart[c] != arena.gridShipStart[c + 1] ||
+                       arena.gridAsteroidStart[c] != arena.gridAsteroidStart[c + 1];
+            if (any) mask |= 1ull << x;
+        }
+        arena.gridRowMask[y] = mask;
+    }
+}
+
+static void BuildAsteroidColliders(const AstroArena& arena, size_t first,
+                                   std::vector<AstroArena::AsteroidCollider>& out) {
+    const auto& asteroids = arena.asteroids;
+    out.resize(asteroids.size());
+    for (size_t i = first; i < asteroids.size(); ++i) {
+        const Asteroid& a = asteroids[i];
+        if (!a.alive || a.shape < 0) continue;
+        auto& c = out[i];
+        c.tr = c2xIdentity();
+        c.tr.p = c2V(a.x, a.y);
+        const c2AABB& box = arena.AsteroidShape(a).box; // precomputed with the library
+        c.box.min = c2Add(box.min, c.tr.p);
+        c.box.max = c2Add(box.max, c.tr.p);
+    }
+}
+
 void AstroArena::RebuildBroadphase() {
     gridCols = (int)std::ceil(ASTROBOTS_W / (float)gridCellSize);
     gridRows = (int)std::ceil(ASTROBOTS_H / (float)gridCellSize);
-    gridAsteroids.assign(gridCols * gridRows, {});
-    gridShips.assign(gridCols * gridRows, {});
-    // Bin asteroids
-    for (size_t i = 0; i < asteroids.size(); ++i) {
-        if (!asteroids[i].alive) continue;
-        int cx, cy; PosToCell(asteroids[i].x, asteroids[i].y, cx, cy);
-        int idx = CellIndex(cx, cy);
-        if (idx >= 0) gridAsteroids[idx].push_back((int)i);
-    }
-    // Bin ships
+    BinObjects(*this, asteroids, gridCellOf, gridAsteroidStart, gridAsteroidItems);
+    BinObjects(*this, ships, gridCellOf, gridShipStart, gridShipItems);
+    BuildRowMasks(*this);
+    gridAsteroidsBinned = asteroids.size();
+
+    shipColliders.resize(ships.size());
     for (size_t i = 0; i < ships.size(); ++i) {
         if (!ships[i].alive) continue;
-        int cx, cy; PosToCell(ships[i].x, ships[i].y, cx, cy);
-        int idx = CellIndex(cx, cy);
-        if (idx >= 0) gridShips[idx].push_back((int)i);
+        auto& c = shipColliders[i];
+        c.cap = MakeShipCapsule(ships[i]);
+        c.box = BoxAround(c.cap.a.x, c.cap.a.y, c.cap.b.x, c.cap.b.y, c.cap.r);
     }
+    BuildAsteroidColliders(*this, 0, asteroidColliders);
+    spatialDirty = false;
 }
 
-void AstroArena::CollectNearCells(int cx, int cy, std::vector<int>& outCellIdx) const {
-    outCellIdx.clear();
+void AstroArena::RefreshBroadphase() {
+    // Between the collision and torpedo passes nothing moves; ships and asteroids
+    // only die (callers skip dead entries) or asteroids break into new ones
+    // appended at the end, which is the one change that needs re-binning
+    if (gridCols <= 0 || spatialDirty) {
+        RebuildBroadphase();
+    } else if (asteroids.size() != gridAsteroidsBinned) {
+        BinObjects(*this, asteroids, gridCellOf, gridAsteroidStart, gridAsteroidItems);
+        BuildRowMasks(*this);
+        BuildAsteroidColliders(*this, gridAsteroidsBinned, asteroidColliders);
+        gridAsteroidsBinned = asteroids.size();
+    }
+}
+
+void AstroArena::CollectNearCells(int cx, int cy, NearCells& out) const {
     for (int dy = -1; dy <= 1; ++dy) {
         for (int dx = -1; dx <= 1; ++dx) {
             int idx = CellIndex(cx + dx, cy + dy);
-            if (idx >= 0) outCellIdx.push_back(idx);
+            if (idx >= 0) out.Add(idx);
         }
     }
 }
@@ -111,23 +216,66 @@ void AstroArena::CollectNearCells(int cx, int cy, std::vector<int>& outCellIdx)
 // Collision helpers (legacy) removed in favor of cute_c2
 
 // ===== Asteroid implementation =====
-void Asteroid::GenerateShape(int sides, float radius) {
-    shape.clear();
-    std::uniform_real_distribution<float> radiusDist(radius * 0.7f, radius * 1.3f);
+c2Poly AstroMakeAsteroidPoly(int sides, float radius, AstroRng& rng) {
+    if (sides > C2_MAX_POLYGON_VERTS) sides = C2_MAX_POLYGON_VERTS;
+    c2Poly poly;
+    poly.count = sides;
     for (int i = 0; i < sides; ++i) {
         float angle = (float)i / sides * 2.0f * M_PI;
-        float r = radiusDist(rng);
-        shape.push_back(ImVec2(std::cos(angle) * r, std::sin(angle) * r));
+        float r = rng.Uniform(radius * 0.7f, radius * 1.3f);
+        poly.verts[i] = c2V(std::cos(angle) * r, std::sin(angle) * r);
     }
-    // Build cute_c2 convex poly (local space)
-    int n = (int)shape.size();
-    if (n > C2_MAX_POLYGON_VERTS) n = C2_MAX_POLYGON_VERTS;
-    poly.count = n;
-    for (int i = 0; i < n; ++i) {
-        poly.verts[i] = c2V(shape[i].x, shape[i].y);
+    c2MakePoly(&poly); // cute_c2 convex hull and normals
+    return poly;
+}
+
+const std::vector<AstroAsteroidShape>& AstroAsteroidShapes() {
+    static const std::vector<AstroAsteroidShape> library = [] {
+        struct Class { int sides; float radius; };
+        const Class classes[ASTRO_ASTEROID_CLASSES] = {
+            { 8, LARGE_ASTEROID_SIZE }, { 7, MEDIUM_ASTEROID_SIZE }, { 6, SMALL_ASTEROID_SIZE }
+        };
+        AstroRng rng;
+        rng.Seed(ASTRO_ASTEROID_SHAPE_SEED, ASTRO_RNG_SHAPES);
+        std::vector<AstroAsteroidShape> shapes;
+        shapes.reserve(ASTRO_ASTEROID_CLASSES * ASTRO_ASTEROID_SHAPES_PER_CLASS);
+        for (const Class& c : classes) {
+            for (int k = 0; k < ASTRO_ASTEROID_SHAPES_PER_CLASS; ++k) {
+                AstroAsteroidShape s;
+                s.poly = AstroMakeAsteroidPoly(c.sides, c.radius, rng);
+                s.box.min = s.box.max = s.poly.verts[0];
+                s.radius = 0.0f;
+                s.area = 0.0f;
+                for (int v = 0; v < s.poly.count; ++v) {
+                    c2v p = s.poly.verts[v];
+                    c2v q = s.poly.verts[(v + 1) % s.poly.count];
+                    s.box.min = c2Minv(s.box.min, p);
+                    s.box.max = c2Maxv(s.box.max, p);
+                    s.radius = std::max(s.radius, c2Len(p));
+                    s.area += 0.5f * c2Det2(p, q);
+                }
+                shapes.push_back(s);
+            }
+        }
+        return shapes;
+    }();
+    return library;
+}
+
+int AstroPickAsteroidShape(AstroAsteroidClass size, AstroRng& rng) {
+    return (int)size * ASTRO_ASTEROID_SHAPES_PER_CLASS + rng.Range(0, ASTRO_ASTEROID_SHAPES_PER_CLASS - 1);
+}
+
+void AstroArena::CompactAsteroids() {
+    size_t kept = 0;
+    for (size_t i = 0; i < asteroids.size(); ++i) {
+        if (!asteroids[i].alive) continue;
+        if (kept != i) asteroids[kept] = asteroids[i];
+        ++kept;
     }
-    c2MakePoly(&poly);
-    hasPoly = true;
+    // the grid and collider cache refer to asteroids by index
+    if (kept != asteroids.size()) spatialDirty = true;
+    asteroids.resize(kept);
 }
 
 // ===== Arena mechanics =====
@@ -141,6 +289,7 @@ void AstroArena::WrapPosition(float& x, float& y) {
 }
 
 void AstroArena::UpdatePhysics() {
+    spatialDirty = true;
     for (auto& s : ships) {
         if (!s.alive) continue;
         float angleDiff = AngleDifference(s.angle, s.targetAngle);
@@ -175,62 +324,29 @@ void AstroArena::UpdatePhysics() {
         t.lifetime--;
         if (t.lifetime <= 0) t.alive = false;
     }
-    for (auto& beam : phaserBeams) {
-        if (!beam.alive) continue;
-        beam.lifetime--;
-        if (beam.lifetime <= 0) beam.alive = false;
-    }
-    for (auto& p : particles) {
-        if (!p.alive) continue;
-        p.x += p.vx;
-        p.y += p.vy;
-        if (PARTICLE_WRAP) {
-            WrapPosition(p.x, p.y);
-        }
-        p.vx *= PARTICLE_DRAG;
-        p.vy *= PARTICLE_DRAG;
-        p.lifetime--;
-        if (p.lifetime <= 0) p.alive = false;
-    }
-    // Update ship debris segments (no wrapping; let them drift off-screen)
-    for (auto& d : shipDebris) {
-        if (!d.alive) continue;
-        // Advance by drift velocity
-        d.x1 += d.vx; d.y1 += d.vy;
-        d.x2 += d.vx; d.y2 += d.vy;
-        // Optional spin about midpoint
-        if (std::abs(d.angVel) > 1e-6f) {
-            float mx = (d.x1 + d.x2) * 0.5f;
-            float my = (d.y1 + d.y2) * 0.5f;
-            float c = std::cos(d.angVel);
-            float s = std::sin(d.angVel);
-            float rx = d.x1 - mx, ry = d.y1 - my;
-            float nx = rx * c - ry * s;
-            float ny = rx * s + ry * c;
-            d.x1 = mx + nx; d.y1 = my + ny;
-            rx = d.x2 - mx; ry = d.y2 - my;
-            nx = rx * c - ry * s;
-            ny = rx * s + ry * c;
-            d.x2 = mx + nx; d.y2 = my + ny;
-        }
-        // Drag
-        d.vx *= SHIP_DEBRIS_DRAG;
-        d.vy *= SHIP_DEBRIS_DRAG;
-        // Lifetime
-        d.lifetime--;
-        if (d.lifetime <= 0) d.alive = false;
-    }
-    // Cleanup expired debris
-    shipDebris.erase(
-        std::remove_if(shipDebris.begin(), shipDebris.end(),
-            [](const ShipDebrisSegment& d){ return !d.alive; }),
-        shipDebris.end()
-    );
+}
+
+void AstroArena::ReservePools() {
+    // the pool sizes cover a typical match; weapons scale with the roster
+    size_t n = ships.size();
+    torpedoes.reserve(std::max(ASTRO_POOL_TORPEDOES, n * 4));
+    asteroids.reserve(ASTRO_POOL_ASTEROIDS);
+    events.reserve(std::max(ASTRO_POOL_EVENTS, n * 4));
+    signals.reserve(ships.size());
+    intents.reserve(ships.size());
+    // broadphase scratch follows the entity counts
+    size_t objects = std::max(ships.size(), ASTRO_POOL_ASTEROIDS);
+    gridCellOf.reserve(objects);
+    gridAsteroidItems.reserve(ASTRO_POOL_ASTEROIDS);
+    asteroidColliders.reserve(ASTRO_POOL_ASTEROIDS);
+    gridShipItems.reserve(ships.size());
+    shipColliders.reserve(ships.size());
 }
 
 void AstroArena::Thrust(int self, float power) {
     auto& s = ships[self];
     if (!s.alive) return;
+    s.effects |= ASTRO_FX_THRUST;
     float fuelCost = power * THRUST_FUEL_COST;
     float effectivePower = power;
     if (s.fuel >= fuelCost) {
@@ -259,6 +375,7 @@ void AstroArena::Thrust(int self, float power) {
 void AstroArena::TurnDeg(int self, int degrees) {
     auto& s = ships[self];
     if (!s.alive) return;
+    s.effects |= ASTRO_FX_TURN;
     s.targetAngle = NormalizeAngle((float)degrees);
 }
 
@@ -266,6 +383,16 @@ void AstroArena::FirePhaser(int self) {
     auto& s = ships[self];
     if (!s.alive || s.phaser_cooldown > 0) return;
     s.phaser_cooldown = PHASER_COOLDOWN;
+    s.effects |= ASTRO_FX_PHASER;
+    if (queueIntents) {
+        intents[self].firePhaser = true;
+        return;
+    }
+    PhaserShot(self);
+}
+
+void AstroArena::PhaserShot(int self) {
+    auto& s = ships[self];
     float angleRad = s.angle * M_PI / 180.0f;
     float dirX = std::cos(angleRad);
     float dirY = std::sin(angleRad);
@@ -275,69 +402,126 @@ void AstroArena::FirePhaser(int self) {
     float hitX = s.x + dirX * PHASER_RANGE;
     float hitY = s.y + dirY * PHASER_RANGE;
     c2Ray ray; ray.p = c2V(s.x, s.y); ray.d = c2V(dirX, dirY); ray.t = PHASER_RANGE;
-    c2Raycast rc;
-    // Ships
-    for (size_t i = 0; i < ships.size(); ++i) {
-        if (i == (size_t)self || !ships[i].alive) continue;
-        c2Capsule cap = MakeShipCapsule(ships[i]);
-        for (int oy = -1; oy <= 1; ++oy) {
-            for (int ox = -1; ox <= 1; ++ox) {
-                c2Capsule wcap = cap;
-                wcap.a = c2Add(wcap.a, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                wcap.b = c2Add(wcap.b, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                c2Raycast out;
-                if (c2RaytoCapsule(ray, wcap, &out)) {
-                    if (out.t < closestDist) {
-                        closestDist = out.t;
-                        hitShip = (int)i;
-                        hitAsteroid = -1;
-                        c2v hp = c2Impact(ray, out.t);
-                        hitX = hp.x; hitY = hp.y;
-                    }
-                }
-            }
+    // Nearest hit wins; ties go to ships, then to the lower index, so the result
+    // does not depend on the order objects are tested in
+    bool found = false;
+    auto record = [&](const c2Raycast& out, int ship, int asteroid) {
+        if (out.t > closestDist || (out.t == closestDist && !found)) return;
+        if (out.t == closestDist) {
+            bool better = ship >= 0 ? (hitShip < 0 || ship < hitShip) : (hitShip < 0 && asteroid < hitAsteroid);
+            if (!better) return;
         }
-    }
-    // Asteroids
-    for (size_t i = 0; i < asteroids.size(); ++i) {
-        if (!asteroids[i].alive || !asteroids[i].hasPoly) continue;
-        std::array<c2x, 9> tr;
-        int trCount = 0;
-        BuildWrapTransforms(asteroids[i].x, asteroids[i].y, tr, trCount);
-        for (int ti = 0; ti < trCount; ++ti) {
-            c2Raycast out;
-            if (c2RaytoPoly(ray, &asteroids[i].poly, &tr[ti], &out)) {
-                if (out.t < closestDist) {
-                    closestDist = out.t;
-                    hitAsteroid = (int)i;
-                    hitShip = -1;
-                    c2v hp = c2Impact(ray, out.t);
-                    hitX = hp.x; hitY = hp.y;
+        closestDist = out.t;
+        hitShip = ship;
+        hitAsteroid = asteroid;
+        c2v hp = c2Impact(ray, out.t);
+        hitX = hp.x; hitY = hp.y;
+        found = true;
+    };
+    // test one wrap image of an object, translated by (offX, offY)
+    c2AABB rayBox = BoxAround(s.x, s.y, hitX, hitY, 0.0f);
+    auto overlaps = [&](const c2AABB& box, float offX, float offY) {
+        return box.max.x + offX >= rayBox.min.x && box.min.x + offX <= rayBox.max.x &&
+               box.max.y + offY >= rayBox.min.y && box.min.y + offY <= rayBox.max.y;
+    };
+    auto testShip = [&](int i, float offX, float offY) {
+        if (i == self || !ships[i].alive) return;
+        const auto& c = shipColliders[i];
+        if (!overlaps(c.box, offX, offY)) return;
+        c2Capsule cap = c.cap;
+        cap.a = c2Add(cap.a, c2V(offX, offY));
+        cap.b = c2Add(cap.b, c2V(offX, offY));
+        c2Raycast out;
+        if (c2RaytoCapsule(ray, cap, &out)) record(out, i, -1);
+    };
+    auto testAsteroid = [&](int i, float offX, float offY) {
+        if (!asteroids[i].alive || asteroids[i].shape < 0) return;
+        const auto& c = asteroidColliders[i];
+        if (!overlaps(c.box, offX, offY)) return;
+        c2x tr = c.tr;
+        tr.p = c2Add(tr.p, c2V(offX, offY));
+        c2Raycast out;
+        if (c2RaytoPoly(ray, &AsteroidPoly(asteroids[i]), &tr, &out)) record(out, -1, i);
+    };
+
+    RefreshBroadphase(); // an earlier shot this turn may have split an asteroid
+    int cs = gridCellSize;
+    int span = (int)std::ceil(PHASER_RANGE / (float)cs) + 3; // cells the walk can touch per axis
+    bool gridUsable = gridCols * cs == (int)ASTROBOTS_W && gridRows * cs == (int)ASTROBOTS_H &&
+                      (float)cs >= MaxColliderExtent() && span < gridCols && span < gridRows;
+    if (!gridUsable) {
+        // the walk below relies on cells tiling the arena exactly and being
+        // larger than any collider; otherwise test every object at the images
+        // that can reach the ray
+        WrapImages img;
+        for (size_t i = 0; i < ships.size(); ++i) {
+            if (!ships[i].alive) continue;
+            SelectWrapImages(shipColliders[i].box, rayBox, img);
+            for (int k = 0; k < img.count; ++k) testShip((int)i, img.off[k].x, img.off[k].y);
+        }
+        for (size_t i = 0; i < asteroids.size(); ++i) {
+            if (!asteroids[i].alive || asteroids[i].shape < 0) continue;
+            SelectWrapImages(asteroidColliders[i].box, rayBox, img);
+            for (int k = 0; k < img.count; ++k) testAsteroid((int)i, img.off[k].x, img.off[k].y);
+        }
+    } else {
+        // Walk the cells the ray crosses (Amanatides-Woo DDA) in unwrapped cell
+        // coordinates. Objects are binned by centre and no collider reaches past
+        // one cell, so anything the ray touches in a cell is binned in that cell
+        // or a neighbour: each step tests the 3x3 block around it, skipping
+        // cells already tested this shot. A hit at distance t is found
+        // by the time the walk enters the cell containing it, so the walk stops
+        // once the next cell starts beyond the closest hit.
+        int cells = gridCols * gridRows;
+        if (gridVisitStamp.size() != (size_t)cells) gridVisitStamp.assign(cells, 0);
+        if (++gridVisitGen == 0) {
+            std::fill(gridVisitStamp.begin(), gridVisitStamp.end(), 0);
+            gridVisitGen = 1;
+        }
+        auto visitBlock = [&](int ux, int uy) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int cx = ux + dx, cy = uy + dy;
+                    int cell = CellIndex(cx, cy);
+                    if (gridVisitStamp[cell] == gridVisitGen) continue;
+                    gridVisitStamp[cell] = gridVisitGen;
+                    // translate the cell's objects to the image at (cx, cy)
+                    float offX = (float)FloorDiv(cx, gridCols) * ASTROBOTS_W;
+                    float offY = (float)FloorDiv(cy, gridRows) * ASTROBOTS_H;
+                    for (int i : ShipsInCell(cell)) testShip(i, offX, offY);
+                    for (int i : AsteroidsInCell(cell)) testAsteroid(i, offX, offY);
                 }
             }
+        };
+        int ux, uy; PosToCell(s.x, s.y, ux, uy);
+        int stepX = dirX > 0 ? 1 : -1, stepY = dirY > 0 ? 1 : -1;
+        const float inf = std::numeric_limits<float>::infinity();
+        float tDeltaX = dirX != 0 ? cs / std::abs(dirX) : inf;
+        float tDeltaY = dirY != 0 ? cs / std::abs(dirY) : inf;
+        float tMaxX = dirX != 0 ? ((ux + (stepX > 0 ? 1 : 0)) * (float)cs - s.x) / dirX : inf;
+        float tMaxY = dirY != 0 ? ((uy + (stepY > 0 ? 1 : 0)) * (float)cs - s.y) / dirY : inf;
+        while (true) {
+            visitBlock(ux, uy);
+            float tNext = std::min(tMaxX, tMaxY);
+            if (tNext > PHASER_RANGE || (found && tNext > closestDist)) break;
+            if (tMaxX < tMaxY) { ux += stepX; tMaxX += tDeltaX; }
+            else { uy += stepY; tMaxY += tDeltaY; }
         }
     }
-    PhaserBeam beam;
-    beam.x1 = s.x; beam.y1 = s.y;
-    beam.x2 = hitX; beam.y2 = hitY;
-    beam.lifetime = 3;
-    beam.color = IM_COL32(255, 100, 100, 255);
-    beam.alive = true;
-    phaserBeams.push_back(beam);
+    Emit(ASTRO_EVENT_PHASER_FIRE, self, s.x, s.y, hitX, hitY);
     if (hitShip >= 0) {
         ships[hitShip].hp -= PHASER_DAMAGE;
-        SpawnParticleBurst(hitX, hitY, 28, IM_COL32(255, 160, 120, 255), 0.8f, 0.7f);
+        Emit(ASTRO_EVENT_PHASER_HIT_SHIP, hitShip, hitX, hitY);
         if (log) {
             std::string attacker = s.ship ? s.ship->name : "Ship";
             std::string target = ships[hitShip].ship ? ships[hitShip].ship->name : "Ship";
             log(attacker + " hits " + target + " with phaser for " + std::to_string(PHASER_DAMAGE) + " damage!");
         }
-        if (ships[hitShip].hp <= 0) {
-            std::string target = ships[hitShip].ship ? ships[hitShip].ship->name : "Ship";
-            KillShip(ships[hitShip], target + " is destroyed!");
+        if (ships[hitShip].hp <= 0 && !queueIntents) {
+            KillShip(ships[hitShip], " is destroyed!");
         }
     } else if (hitAsteroid >= 0) {
-        SpawnParticleBurst(hitX, hitY, 36, IM_COL32(255, 120, 120, 255), 0.9f, 0.8f);
+        Emit(ASTRO_EVENT_PHASER_HIT_ASTEROID, -1, hitX, hitY);
         BreakAsteroid(hitAsteroid, s.x, s.y);
         s.fuel += FUEL_HIT_REWARD;
         if (s.fuel > ASTRO_START_FUEL) s.fuel = ASTRO_START_FUEL;
@@ -351,6 +535,16 @@ void AstroArena::FirePhoton(int self) {
     auto& s = ships[self];
     if (!s.alive || s.photon_cooldown > 0) return;
     s.photon_cooldown = PHOTON_COOLDOWN;
+    s.effects |= ASTRO_FX_PHOTON;
+    if (queueIntents) {
+        intents[self].firePhoton = true;
+        return;
+    }
+    LaunchPhoton(self);
+}
+
+void AstroArena::LaunchPhoton(int self) {
+    auto& s = ships[self];
     PhotonTorpedo t;
     t.x = s.x;
     t.y = s.y;
@@ -363,54 +557,143 @@ void AstroArena::FirePhoton(int self) {
     t.damage = PHOTON_DAMAGE;
     t.owner = self;
     t.alive = true;
-    std::uniform_real_distribution<float> phaseDist(0.0f, 2.0f * (float)M_PI);
-    t.anim = phaseDist(rng);
+    t.anim = (float)self * 2.4f; // spread the spin phase per ship without a random draw
     torpedoes.push_back(t);
+    Emit(ASTRO_EVENT_PHOTON_FIRE, self, s.x, s.y);
     if (log) {
         std::string attacker = s.ship ? s.ship->name : "Ship";
         log(attacker + " fires photon torpedo!");
     }
 }
 
-void AstroArena::Scan(int self) {
+void AstroArena::Scan(int self, bool linear) {
     auto& s = ships[self];
     if (!s.alive) return;
-    float closestDist = ASTRO_SCAN_RANGE;
-    float closestAngle = 0;
+    s.effects |= ASTRO_FX_SCAN;
+    // Nearest live ship or asteroid within scan range, measured across the wrap
+    // seams. Ties go to ships, then to the lower index, so the result does not
+    // depend on the order cells are visited.
+    float best = ASTRO_SCAN_RANGE * ASTRO_SCAN_RANGE;
+    float bestDx = 0, bestDy = 0;
+    int bestKind = 2, bestIdx = 0; // kind 0 = ship, 1 = asteroid
     bool found = false;
-    for (size_t i = 0; i < ships.size(); ++i) {
-        if (i == (size_t)self || !ships[i].alive) continue;
-        float dist = Distance(s.x, s.y, ships[i].x, ships[i].y);
-        if (dist < closestDist) {
-            closestDist = dist;
-            closestAngle = AngleTo(s.x, s.y, ships[i].x, ships[i].y);
+    auto consider = [&](float ox, float oy, int kind, int idx) {
+        float dx = WrapDelta(ox - s.x, ASTROBOTS_W);
+        float dy = WrapDelta(oy - s.y, ASTROBOTS_H);
+        float d2 = dx * dx + dy * dy;
+        if (d2 < best || (found && d2 == best && (kind < bestKind || (kind == bestKind && idx < bestIdx)))) {
+            best = d2;
+            bestDx = dx; bestDy = dy;
+            bestKind = kind; bestIdx = idx;
             found = true;
         }
-    }
-    for (auto& a : asteroids) {
-        if (!a.alive) continue;
-        float dist = Distance(s.x, s.y, a.x, a.y);
-        if (dist < closestDist) {
-            closestDist = dist;
-            closestAngle = AngleTo(s.x, s.y, a.x, a.y);
-            found = true;
+    };
+    auto visitCell = [&](int cell) {
+        for (int i : ShipsInCell(cell)) {
+            if (i != self && ships[i].alive) consider(ships[i].x, ships[i].y, 0, i);
+        }
+        for (int i : AsteroidsInCell(cell)) {
+            if (asteroids[i].alive) consider(asteroids[i].x, asteroids[i].y, 1, i);
+        }
+    };
+
+    // a phaser earlier this turn may have split an asteroid (sequential turns only)
+    if (!linear) RefreshBroadphase();
+    int cs = gridCellSize;
+    int reach = (int)std::floor(ASTRO_SCAN_RANGE / (float)cs) + 1; // cells the range can touch each way
+    bool gridUsable = gridCols * cs == (int)ASTROBOTS_W && gridRows * cs == (int)ASTROBOTS_H && gridCols <= 64 &&
+                      2 * reach + 1 <= gridCols && 2 * reach + 1 <= gridRows;
+    if (linear || !gridUsable) {
+        // uneven cells or a window that would wrap onto itself break the cell
+        // distance bound; a straight pass gives the same answer
+        for (size_t i = 0; i < ships.size(); ++i) {
+            if ((int)i != self && ships[i].alive) consider(ships[i].x, ships[i].y, 0, (int)i);
+        }
+        for (size_t i = 0; i < asteroids.size(); ++i) {
+            if (asteroids[i].alive) consider(asteroids[i].x, asteroids[i].y, 1, (int)i);
+        }
+    } else {
+        // Search the (2 * reach + 1)^2 window of cells around the scanner,
+        // visiting only occupied cells (gridRowMask). The scanner's own cell
+        // goes first and then the rows nearest first, each masked to the
+        // columns that could still hold something closer than the best hit,
+        // so a crowded arena narrows down to a few cells and an empty stretch
+        // costs a word test per row.
+        int cx, cy; PosToCell(s.x, s.y, cx, cy);
+        float fx = s.x - (float)(cx * cs), fy = s.y - (float)(cy * cs);
+        // gap from the scanner to the cell `d` columns (rows) away
+        auto gap = [cs](int d, float f) {
+            return d > 0 ? (float)(d * cs) - f : (d < 0 ? (float)((-d - 1) * cs) + f : 0.0f);
+        };
+        int home = CellIndex(cx, cy);
+        cx = home % gridCols;
+        cy = home / gridCols;
+        // the window never spans the grid, so one compare wraps a coordinate
+        auto wrap = [](int c, int n) { return c < 0 ? c + n : (c >= n ? c - n : c); };
+        // columns cx + lo .. cx + hi as a mask (fewer than 64, since gridCols <= 64)
+        auto colSpan = [&](int lo, int hi) {
+            int first = wrap(cx + lo, gridCols), len = hi - lo + 1;
+            uint64_t run = (1ull << len) - 1;
+            uint64_t span = run << first;
+            if (first + len > gridCols) span |= run >> (gridCols - first);
+            return gridCols < 64 ? span & ((1ull << gridCols) - 1) : span;
+        };
+        auto visitRow = [&](int y, float gy, uint64_t cols) {
+            for (; cols; cols &= cols - 1) {
+                int x = std::countr_zero(cols);
+                int dx = x - cx;
+                if (dx > reach) dx -= gridCols;
+                else if (dx < -reach) dx += gridCols;
+                float gx = gap(dx, fx);
+                if (gx * gx + gy * gy <= best) visitCell(y * gridCols + x); // equal stays in for the tie-break
+            }
+        };
+
+        uint64_t window = colSpan(-reach, reach);
+        uint64_t homeCol = colSpan(0, 0);
+        visitRow(cy, 0.0f, gridRowMask[cy] & homeCol);
+        for (int step = 0; step <= 2 * reach; ++step) {
+            int dy = (step & 1) ? -(step + 1) / 2 : step / 2; // 0, -1, 1, -2, 2, ...
+            int y = wrap(cy + dy, gridRows);
+            uint64_t occupied = gridRowMask[y] & window;
+            if (dy == 0) occupied &= ~homeCol;
+            if (!occupied) continue;
+            float gy = gap(dy, fy);
+            if (gy * gy > best) continue;
+            if (std::popcount(occupied) > 2) {
+                // narrow to the columns whose gap fits in what is left of the best
+                // distance, one cell wider each way so rounding never drops one;
+                // visitRow tests each cell exactly
+                float left = std::sqrt(best - gy * gy);
+                int hi = std::min(reach, (int)std::floor((left + fx) / (float)cs) + 1);
+                int lo = -std::min(reach, std::max((int)std::floor((left - fx) / (float)cs) + 2, 0));
+                occupied &= colSpan(lo, hi);
+            }
+            visitRow(y, gy, occupied);
         }
     }
+
     s.scan_hit = found;
-    s.scan_dist = closestDist;
-    s.scan_angle = NormalizeAngle(closestAngle);
+    s.scan_dist = found ? std::sqrt(best) : ASTRO_SCAN_RANGE;
+    s.scan_angle = found ? NormalizeAngle(std::atan2(bestDy, bestDx) * 180.0f / (float)M_PI) : 0.0f;
 }
 
 void AstroArena::Signal(int self, int value) {
     auto& s = ships[self];
     if (!s.alive) return;
+    s.effects |= ASTRO_FX_SIGNAL;
     s.signal = value;
+    if (queueIntents) {
+        intents[self].signals++;
+        return;
+    }
     signals.emplace_back(s.x, s.y);
 }
 
 void AstroArena::TurnToScan(int self) {
     auto& s = ships[self];
     if (!s.alive || !s.scan_hit) return;
+    s.effects |= ASTRO_FX_TURN;
     s.targetAngle = s.scan_angle;
 }
 
@@ -425,31 +708,32 @@ void AstroArena::HandleCollisions() {
         auto& s = ships[si];
         if (!s.alive) continue;
         int scx, scy; PosToCell(s.x, s.y, scx, scy);
-        std::vector<int> cellIdx;
+        NearCells cellIdx;
         CollectNearCells(scx, scy, cellIdx);
         for (int cell : cellIdx) {
-            const auto& bucket = gridAsteroids[cell];
-            for (int ai : bucket) {
+            for (int ai : AsteroidsInCell(cell)) {
                 auto& a = asteroids[ai];
             if (!a.alive) continue;
+            if (a.shape < 0) continue;
             // Ship vs asteroid using cute_c2 (capsule vs poly with wrap)
             bool hit = false;
-            c2Capsule shipCap = MakeShipCapsule(s);
-            std::array<c2x, 9> tr;
-            int trCount = 0;
-            BuildWrapTransforms(a.x, a.y, tr, trCount);
-            for (int ti = 0; ti < trCount && !hit; ++ti) {
-                if (a.hasPoly && c2CapsuletoPoly(shipCap, &a.poly, &tr[ti])) {
+            const auto& shipCol = shipColliders[si];
+            const auto& astCol = asteroidColliders[ai];
+            WrapImages img;
+            SelectWrapImages(astCol.box, shipCol.box, img);
+            for (int ti = 0; ti < img.count && !hit; ++ti) {
+                c2x tr = astCol.tr;
+                tr.p = c2Add(tr.p, img.off[ti]);
+                if (c2CapsuletoPoly(shipCol.cap, &AsteroidPoly(a), &tr)) {
                     hit = true;
                 }
             }
             if (hit) {
                 s.hp -= 1;
                 a.hp--;
-                SpawnParticleBurst(s.x, s.y, 24, IM_COL32(255, 150, 120, 255));
+                Emit(ASTRO_EVENT_RAM_ASTEROID, (int)si, s.x, s.y);
                 if (s.hp <= 0) {
-                    std::string name = s.ship ? s.ship->name : "Ship";
-                    KillShip(s, name + " destroyed by asteroid collision!");
+                    KillShip(s, " destroyed by asteroid collision!");
                 }
                 if (a.hp <= 0) {
                         BreakAsteroid((int)ai, s.x, s.y);
@@ -461,7 +745,7 @@ void AstroArena::HandleCollisions() {
 }
 
 void AstroArena::HandleTorpedoes() {
-    RebuildBroadphase();
+    RefreshBroadphase();
     for (auto& t : torpedoes) {
         if (!t.alive) continue;
         // Prepare swept circle for torpedo using c2TOI
@@ -481,31 +765,30 @@ void AstroArena::HandleTorpedoes() {
         int c0x, c0y, c1x, c1y;
         PosToCell(t.prevX, t.prevY, c0x, c0y);
         PosToCell(t.x, t.y, c1x, c1y);
-        std::vector<int> cells;
+        NearCells cells;
         CollectNearCells(c0x, c0y, cells);
-        std::vector<int> cells2;
-        CollectNearCells(c1x, c1y, cells2);
-        cells.insert(cells.end(), cells2.begin(), cells2.end());
+        CollectNearCells(c1x, c1y, cells);
+        // bounding box of the swept circle, for picking wrap images
+        c2AABB sweptBox = BoxAround(t.prevX, t.prevY, t.x, t.y, torpCircle.r);
+        WrapImages img;
 
         // Against ships
         for (int cell : cells) {
-            const auto& sbucket = gridShips[cell];
-            for (int si : sbucket) {
+            for (int si : ShipsInCell(cell)) {
                 if (si == t.owner || !ships[si].alive) continue;
-                c2Capsule shipCap = MakeShipCapsule(ships[si]);
-                for (int oy = -1; oy <= 1; ++oy) {
-                    for (int ox = -1; ox <= 1; ++ox) {
-                        c2Capsule wcap = shipCap;
-                        wcap.a = c2Add(wcap.a, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                        wcap.b = c2Add(wcap.b, c2V(ox * ASTROBOTS_W, oy * ASTROBOTS_H));
-                        c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &wcap, C2_TYPE_CAPSULE, nullptr, c2V(0, 0), 1);
-                        if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
-                            bestToi = res.toi;
-                            hitType = HIT_SHIP;
-                            hitIndex = si;
-                            hitPoint = res.p;
-                            anyHit = true;
-                        }
+                const auto& shipCol = shipColliders[si];
+                SelectWrapImages(shipCol.box, sweptBox, img);
+                for (int ti = 0; ti < img.count; ++ti) {
+                    c2Capsule wcap = shipCol.cap;
+                    wcap.a = c2Add(wcap.a, img.off[ti]);
+                    wcap.b = c2Add(wcap.b, img.off[ti]);
+                    c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &wcap, C2_TYPE_CAPSULE, nullptr, c2V(0, 0), 1);
+                    if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
+                        bestToi = res.toi;
+                        hitType = HIT_SHIP;
+                        hitIndex = si;
+                        hitPoint = res.p;
+                        anyHit = true;
                     }
                 }
             }
@@ -513,14 +796,14 @@ void AstroArena::HandleTorpedoes() {
 
         // Against asteroids
         for (int cell : cells) {
-            const auto& abucket = gridAsteroids[cell];
-            for (int ai : abucket) {
-                if (!asteroids[ai].alive || !asteroids[ai].hasPoly) continue;
-                std::array<c2x, 9> tr;
-                int trCount = 0;
-                BuildWrapTransforms(asteroids[ai].x, asteroids[ai].y, tr, trCount);
-                for (int ti = 0; ti < trCount; ++ti) {
-                    c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &asteroids[ai].poly, C2_TYPE_POLY, &tr[ti], c2V(0, 0), 1);
+            for (int ai : AsteroidsInCell(cell)) {
+                if (!asteroids[ai].alive || asteroids[ai].shape < 0) continue;
+                const auto& astCol = asteroidColliders[ai];
+                SelectWrapImages(astCol.box, sweptBox, img);
+                for (int ti = 0; ti < img.count; ++ti) {
+                    c2x tr = astCol.tr;
+                    tr.p = c2Add(tr.p, img.off[ti]);
+                    c2TOIResult res = c2TOI(&torpCircle, C2_TYPE_CIRCLE, nullptr, vA, &AsteroidPoly(asteroids[ai]), C2_TYPE_POLY, &tr, c2V(0, 0), 1);
                     if (res.hit && res.toi >= 0.0f && res.toi <= bestToi) {
                         bestToi = res.toi;
                         hitType = HIT_AST;
@@ -537,20 +820,17 @@ void AstroArena::HandleTorpedoes() {
             t.alive = false;
             if (hitType == HIT_SHIP && hitIndex >= 0) {
                 ships[hitIndex].hp -= t.damage;
-                SpawnParticleBurst(ships[hitIndex].x, ships[hitIndex].y, 42, IM_COL32(255, 200, 140, 255), 1.0f, 1.0f);
-                SpawnParticleBurst(ships[hitIndex].x, ships[hitIndex].y, 20, IM_COL32(255, 255, 200, 255), 1.7f, 0.5f);
+                Emit(ASTRO_EVENT_TORPEDO_HIT_SHIP, hitIndex, ships[hitIndex].x, ships[hitIndex].y);
                 if (log) {
                     std::string attacker = (t.owner >= 0 && ships[t.owner].ship) ? ships[t.owner].ship->name : "Ship";
                     std::string target = ships[hitIndex].ship ? ships[hitIndex].ship->name : "Ship";
                     log(attacker + "'s torpedo hits " + target + " for " + std::to_string(t.damage) + " damage!");
                 }
                 if (ships[hitIndex].hp <= 0) {
-                    std::string target = ships[hitIndex].ship ? ships[hitIndex].ship->name : "Ship";
-                    KillShip(ships[hitIndex], target + " is destroyed!");
+                    KillShip(ships[hitIndex], " is destroyed!");
                 }
             } else if (hitType == HIT_AST && hitIndex >= 0) {
-                SpawnParticleBurst(hitPoint.x, hitPoint.y, 48, IM_COL32(255, 180, 140, 255), 1.0f, 1.0f);
-                SpawnParticleBurst(hitPoint.x, hitPoint.y, 25, IM_COL32(255, 255, 200, 255), 1.8f, 0.6f);
+                Emit(ASTRO_EVENT_TORPEDO_HIT_ASTEROID, t.owner, hitPoint.x, hitPoint.y);
                 BreakAsteroid(hitIndex, t.x, t.y);
                 if (t.owner >= 0 && t.owner < (int)ships.size()) {
                     ships[t.owner].fuel += FUEL_HIT_REWARD;
@@ -561,101 +841,36 @@ void AstroArena::HandleTorpedoes() {
     }
 }
 
-void AstroArena::KillShip(ShipState& s, const std::string& message) {
+void AstroArena::KillShip(ShipState& s, const char* reason) {
     if (!s.alive) return;
     s.alive = false;
-    if (log) log(message);
-    SpawnParticleBurst(s.x, s.y, 150, s.color, 1.2f, 1.5f);
-    SpawnParticleBurst(s.x, s.y, 80, IM_COL32(255, 255, 220, 255), 2.2f, 0.8f);
-
-    // Spawn Asteroids-style breakup debris from the triangle outline
-    // Reconstruct ship triangle in world space
-    float angleRad = s.angle * (float)M_PI / 180.0f;
-    // Convert screen-size triangle length to world units using current renderScale
-    float size = SHIP_DRAW_SIZE;
-    if (renderScale > 0.00001f) {
-        size = SHIP_DRAW_SIZE / renderScale;
-    }
-    ImVec2 nose(s.x + std::cos(angleRad) * size,
-                s.y + std::sin(angleRad) * size);
-    ImVec2 leftWing(s.x + std::cos(angleRad + 2.4f) * size * 0.6f,
-                    s.y + std::sin(angleRad + 2.4f) * size * 0.6f);
-    ImVec2 rightWing(s.x + std::cos(angleRad - 2.4f) * size * 0.6f,
-                     s.y + std::sin(angleRad - 2.4f) * size * 0.6f);
-
-    // Triangle centroid
-    ImVec2 center((nose.x + leftWing.x + rightWing.x) / 3.0f,
-                  (nose.y + leftWing.y + rightWing.y) / 3.0f);
-
-    std::array<std::pair<ImVec2, ImVec2>, 3> edges = {{
-        { nose, leftWing },
-        { leftWing, rightWing },
-        { rightWing, nose }
-    }};
-
-    std::uniform_real_distribution<float> jitter(-0.07f, 0.07f);
-    std::uniform_real_distribution<float> speedDist(0.6f, 1.8f);
-    std::uniform_real_distribution<float> angVelDist(-0.05f, 0.05f);
-    std::uniform_int_distribution<int> lifeJitter(-10, 10);
-
-    for (const auto& e : edges) {
-        ImVec2 a = e.first;
-        ImVec2 b = e.second;
-        for (int i = 0; i < SHIP_DEBRIS_COUNT_PER_EDGE; ++i) {
-            float t0 = (float)i / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
-            float t1 = (float)(i + 1) / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
-            t0 = std::max(0.0f, std::min(1.0f, t0 + jitter(rng)));
-            t1 = std::max(0.0f, std::min(1.0f, t1 + jitter(rng)));
-            if (t1 < t0) std::swap(t0, t1);
-            ImVec2 p0(a.x + (b.x - a.x) * t0, a.y + (b.y - a.y) * t0);
-            ImVec2 p1(a.x + (b.x - a.x) * t1, a.y + (b.y - a.y) * t1);
-
-            // Midpoint and outward direction from centroid
-            ImVec2 mid((p0.x + p1.x) * 0.5f, (p0.y + p1.y) * 0.5f);
-            float dx = mid.x - center.x;
-            float dy = mid.y - center.y;
-            float len = std::sqrt(dx*dx + dy*dy);
-            if (len < 1e-5f) { dx = 1.0f; dy = 0.0f; len = 1.0f; }
-            dx /= len; dy /= len;
-
-            float spd = speedDist(rng);
-
-            ShipDebrisSegment seg;
-            seg.x1 = p0.x; seg.y1 = p0.y;
-            seg.x2 = p1.x; seg.y2 = p1.y;
-            // Inherit some ship velocity, add outward impulse and slight downward bias
-            seg.vx = s.vx + dx * spd;
-            seg.vy = s.vy + dy * spd + 0.15f;
-            seg.angVel = angVelDist(rng);
-            seg.startLifetime = SHIP_DEBRIS_LIFETIME + lifeJitter(rng);
-            if (seg.startLifetime < 20) seg.startLifetime = 20;
-            seg.lifetime = seg.startLifetime;
-            seg.color = s.color;
-            seg.alive = true;
-            shipDebris.push_back(seg);
-        }
+    if (log) {
+        std::string name = s.ship ? s.ship->name : "Ship";
+        log(name + reason);
     }
+    Emit(ASTRO_EVENT_SHIP_KILLED, (int)(&s - ships.data()), s.x, s.y);
 }
 
 void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY) {
     if (asteroidIdx < 0 || asteroidIdx >= (int)asteroids.size()) return;
-    auto& a = asteroids[asteroidIdx];
-    if (!a.alive) return;
-    a.alive = false;
-    std::uniform_real_distribution<float> angleDist(0, 2.0f * M_PI);
-    std::uniform_real_distribution<float> speedDist(0.5f, ASTEROID_MAX_SPEED);
-    std::uniform_int_distribution<int> countDist(2, 3);
+    if (!asteroids[asteroidIdx].alive) return;
+    asteroids[asteroidIdx].alive = false;
+    Emit(ASTRO_EVENT_ASTEROID_BREAK, -1, asteroids[asteroidIdx].x, asteroids[asteroidIdx].y);
+    // Fragments are appended to `asteroids` below, which can reallocate it,
+    // so work from a copy of the parent rather than a reference into the vector.
+    const Asteroid a = asteroids[asteroidIdx];
+    AstroRng& rng = rngAsteroids;
     float pushAngle = 0;
     float pushSpeed = 1.5f;
     bool hasPush = (pushFromX >= 0 && pushFromY >= 0);
     if (hasPush) pushAngle = AngleTo(pushFromX, pushFromY, a.x, a.y) * M_PI / 180.0f;
     if (a.size > MEDIUM_ASTEROID_SIZE) {
-        int count = countDist(rng);
+        int count = rng.Range(2, 3);
         for (int i = 0; i < count; ++i) {
             Asteroid newAst;
             newAst.x = a.x; newAst.y = a.y;
-            float angle = angleDist(rng);
-            float speed = speedDist(rng);
+            float angle = rng.Uniform(0.0f, 2.0f * (float)M_PI);
+            float speed = rng.Uniform(0.5f, ASTEROID_MAX_SPEED);
             if (hasPush) {
                 float angleOffset = (float)(i - count / 2) * 0.8f;
                 angle = pushAngle + angleOffset;
@@ -666,16 +881,16 @@ void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY
             newAst.size = MEDIUM_ASTEROID_SIZE;
             newAst.hp = MEDIUM_ASTEROID_HP;
             newAst.alive = true;
-            newAst.GenerateShape(7, MEDIUM_ASTEROID_SIZE);
+            newAst.shape = AstroPickAsteroidShape(ASTRO_ASTEROID_MEDIUM, rng);
             asteroids.push_back(newAst);
         }
     } else if (a.size > SMALL_ASTEROID_SIZE) {
-        int count = countDist(rng);
+        int count = rng.Range(2, 3);
         for (int i = 0; i < count; ++i) {
             Asteroid newAst;
             newAst.x = a.x; newAst.y = a.y;
-            float angle = angleDist(rng);
-            float speed = speedDist(rng);
+            float angle = rng.Uniform(0.0f, 2.0f * (float)M_PI);
+            float speed = rng.Uniform(0.5f, ASTEROID_MAX_SPEED);
             if (hasPush) {
                 float angleOffset = (float)(i - count / 2) * 0.8f;
                 angle = pushAngle + angleOffset;
@@ -686,7 +901,7 @@ void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY
             newAst.size = SMALL_ASTEROID_SIZE;
             newAst.hp = SMALL_ASTEROID_HP;
             newAst.alive = true;
-            newAst.GenerateShape(6, SMALL_ASTEROID_SIZE);
+            newAst.shape = AstroPickAsteroidShape(ASTRO_ASTEROID_SMALL, rng);
             asteroids.push_back(newAst);
         }
     } else {
@@ -706,84 +921,75 @@ void AstroArena::BreakAsteroid(int asteroidIdx, float pushFromX, float pushFromY
 }
 
 void AstroArena::SpawnAsteroids(int count) {
-    std::uniform_real_distribution<float> xDist(100.0f, ASTROBOTS_W - 100.0f);
-    std::uniform_real_distribution<float> yDist(100.0f, ASTROBOTS_H - 100.0f);
-    std::uniform_real_distribution<float> angleDist(0, 2.0f * M_PI);
-    std::uniform_real_distribution<float> speedDist(0.3f, ASTEROID_MAX_SPEED);
+    AstroRng& rng = rngAsteroids;
     for (int i = 0; i < count; ++i) {
         Asteroid a;
-        a.x = xDist(rng);
-        a.y = yDist(rng);
-        float angle = angleDist(rng);
-        float speed = speedDist(rng);
+        a.x = rng.Uniform(100.0f, ASTROBOTS_W - 100.0f);
+        a.y = rng.Uniform(100.0f, ASTROBOTS_H - 100.0f);
+        float angle = rng.Uniform(0.0f, 2.0f * (float)M_PI);
+        float speed = rng.Uniform(0.3f, ASTEROID_MAX_SPEED);
         a.vx = std::cos(angle) * speed;
         a.vy = std::sin(angle) * speed;
         a.size = LARGE_ASTEROID_SIZE;
         a.hp = LARGE_ASTEROID_HP;
         a.alive = true;
-        a.GenerateShape(8, LARGE_ASTEROID_SIZE);
+        a.shape = AstroPickAsteroidShape(ASTRO_ASTEROID_LARGE, rng);
         asteroids.push_back(a);
     }
 }
 
 void AstroArena::SpawnAsteroidFromEdge() {
-    std::uniform_int_distribution<int> edgeDist(0, 3);
-    std::uniform_real_distribution<float> alongX(0.0f, ASTROBOTS_W);
-    std::uniform_real_distribution<float> alongY(0.0f, ASTROBOTS_H);
-    std::uniform_real_distribution<float> angleJitter(-M_PI/12.0f, M_PI/12.0f);
-    std::uniform_real_distribution<float> speedDist(0.4f, ASTEROID_MAX_SPEED);
+    AstroRng& rng = rngAsteroids;
     Asteroid a;
-    int edge = edgeDist(rng);
+    int edge = rng.Range(0, 3);
     float inset = 8.0f;
     float cx = ASTROBOTS_W * 0.5f;
     float cy = ASTROBOTS_H * 0.5f;
-    if (edge == 0) { a.x = alongX(rng); a.y = inset; }
-    else if (edge == 1) { a.x = ASTROBOTS_W - inset; a.y = alongY(rng); }
-    else if (edge == 2) { a.x = alongX(rng); a.y = ASTROBOTS_H - inset; }
-    else { a.x = inset; a.y = alongY(rng); }
+    if (edge == 0) { a.x = rng.Uniform(0.0f, ASTROBOTS_W); a.y = inset; }
+    else if (edge == 1) { a.x = ASTROBOTS_W - inset; a.y = rng.Uniform(0.0f, ASTROBOTS_H); }
+    else if (edge == 2) { a.x = rng.Uniform(0.0f, ASTROBOTS_W); a.y = ASTROBOTS_H - inset; }
+    else { a.x = inset; a.y = rng.Uniform(0.0f, ASTROBOTS_H); }
     float baseAngle = AngleTo(a.x, a.y, cx, cy) * (float)(M_PI / 180.0f);
-    float angle = baseAngle + angleJitter(rng);
-    float speed = speedDist(rng);
+    float angle = baseAngle + rng.Uniform(-(float)M_PI / 12.0f, (float)M_PI / 12.0f);
+    float speed = rng.Uniform(0.4f, ASTEROID_MAX_SPEED);
     a.vx = std::cos(angle) * speed;
     a.vy = std::sin(angle) * speed;
     a.size = LARGE_ASTEROID_SIZE;
     a.hp = LARGE_ASTEROID_HP;
     a.alive = true;
-    a.GenerateShape(8, LARGE_ASTEROID_SIZE);
+    a.shape = AstroPickAsteroidShape(ASTRO_ASTEROID_LARGE, rng);
     asteroids.push_back(a);
 }
 
-void AstroArena::SpawnParticleBurst(float x, float y, int count, ImU32 baseColor, float speedScale, float lifeScale, float particleLength) {
-    std::uniform_real_distribution<float> ang(0.0f, 2.0f * (float)M_PI);
-    std::uniform_real_distribution<float> spd(PARTICLE_MIN_SPEED, PARTICLE_MAX_SPEED);
-    std::uniform_int_distribution<int> life(PARTICLE_DEFAULT_LIFETIME - 15, PARTICLE_DEFAULT_LIFETIME + 15);
-    std::uniform_real_distribution<float> lenDist(0.7f, 1.3f);
-    std::uniform_int_distribution<int> colorJitter(-40, 40);
-    for (int i = 0; i < count; ++i) {
-        float a = ang(rng);
-        float s = spd(rng) * speedScale;
-        Particle p;
-        p.x = x; p.y = y;
-        p.vx = std::cos(a) * s;
-        p.vy = std::sin(a) * s;
-        p.lifetime = std::max(10, (int)(life(rng) * lifeScale));
-        p.startLifetime = p.lifetime;
-        p.length = particleLength * lenDist(rng);
-        int r = (int)((baseColor >> IM_COL32_R_SHIFT) & 0xFF);
-        int g = (int)((baseColor >> IM_COL32_G_SHIFT) & 0xFF);
-        int b = (int)((baseColor >> IM_COL32_B_SHIFT) & 0xFF);
-        r = std::min(255, std::max(0, r + colorJitter(rng)));
-        g = std::min(255, std::max(0, g + colorJitter(rng)));
-        b = std::min(255, std::max(0, b + colorJitter(rng)));
-        p.color = IM_COL32(r, g, b, 255);
-        p.alive = true;
-        particles.push_back(p);
+// ===== Two-phase turns =====
+void AstroArena::BeginIntents() {
+    intents.assign(ships.size(), Intent());
+    queueIntents = true;
+}
+
+void AstroArena::ResolveIntents() {
+    // queueIntents stays set while resolving so phaser hits don't kill yet
+    for (size_t i = 0; i < intents.size(); ++i) {
+        const Intent& in = intents[i];
+        if (in.firePhaser) PhaserShot((int)i);
+        if (in.firePhoton) LaunchPhoton((int)i);
+        for (int k = 0; k < in.signals; ++k) signals.emplace_back(ships[i].x, ships[i].y);
+    }
+    queueIntents = false;
+    for (auto& s : ships) {
+        if (s.alive && s.hp <= 0) KillShip(s, " is destroyed!");
     }
 }
 
 void AstroArena::StartTurn() {
     signals.clear();
+    events.clear();
+    // scans and phasers read the grid and colliders during the script phase;
+    // make sure they match this turn's positions before any script (possibly
+    // on another thread) runs. Normally HandleCollisions built them already.
+    if (spatialDirty) RebuildBroadphase();
     for (auto& s : ships) {
+        s.effects = 0;
         if (!s.alive) continue;
         if (s.phaser_cooldown > 0) --s.phaser_cooldown;
         if (s.photon_cooldown > 0) --s.photon_cooldown;
@@ -5,6 +5,7 @@ struct ShipBase;
 #include <vector>
 #include <string>
 #include <functional>
+#include <cmath>
 
 #include "AstroTypes.h"
 
@@ -31,27 +32,89 @@ struct AstroArena {
         // signal
         int signal = -1;
 
-        ImU32 color; // ship color
+        // actions that took effect this turn (AstroShipEffect bits), for replays
+        uint8_t effects = 0;
+
+        AstroColor color = 0; // ship color
     };
 
     std::vector<ShipState> ships;
     std::vector<PhotonTorpedo> torpedoes;
-    std::vector<PhaserBeam> phaserBeams;
-    std::vector<Particle> particles;
     std::vector<Asteroid> asteroids;
-    std::vector<ShipDebrisSegment> shipDebris;
+    // Asteroid outlines come from the shared shape library (building it, if
+    // this is the first arena); an Asteroid only holds its shape index
+    const AstroAsteroidShape* asteroidShapes = AstroAsteroidShapes().data();
+    const AstroAsteroidShape& AsteroidShape(const Asteroid& a) const { return asteroidShapes[a.shape]; }
+    const c2Poly& AsteroidPoly(const Asteroid& a) const { return asteroidShapes[a.shape].poly; }
+    void CompactAsteroids(); // erase dead asteroids
     std::vector<std::pair<float,float>> signals; // positions
-    std::function<void(const std::string&)> log;
+    std::function<void(const std::string&)> log; // optional; left empty for headless/batch runs
+
+    // This turn's events for renderers (see AstroEffects); cleared by StartTurn.
+    // Headless runs leave recordEvents off and pay one branch per event.
+    std::vector<AstroEvent> events;
+    bool recordEvents = false;
+    void Emit(AstroEventType type, int ship, float x, float y, float x2 = 0.0f, float y2 = 0.0f) {
+        if (recordEvents) events.push_back({ type, ship, x, y, x2, y2 });
+    }
+
+    // The entity vectors double as pools: dead entries are compacted away in
+    // place each turn (order-preserving, so gameplay index order is unchanged)
+    // and the storage is kept across turns and matches, so once a match has
+    // warmed up a turn does not touch the heap. ReservePools() sizes them up
+    // front so most matches never grow them at all.
+    void ReservePools();
+
+    // Gameplay RNG, derived from the match seed. The cosmetic particle and
+    // debris streams belong to AstroEffects, which seeds them from matchSeed.
+    uint64_t matchSeed = 0;
+    AstroRng rngAsteroids;
+    void Seed(uint64_t seed) {
+        matchSeed = seed;
+        rngAsteroids.Seed(seed, ASTRO_RNG_ASTEROIDS);
+    }
 
     // Rendering scale (screen pixels per world unit), set by renderer each frame
     float renderScale = 1.0f;
     // Broad-phase uniform grid (Phase 2)
+    // Flat counting-sort layout: cell c holds items[start[c]] .. items[start[c+1]-1],
+    // in ascending object index. The arrays persist between turns, so binning
+    // never allocates once they have grown to size.
+    struct GridBucket {
+        const int* first;
+        const int* last;
+        const int* begin() const { return first; }
+        const int* end() const { return last; }
+    };
     int gridCellSize = 128;
     int gridCols = 0;
     int gridRows = 0;
-    std::vector<std::vector<int>> gridAsteroids; // per-cell asteroid indices
-    std::vector<std::vector<int>> gridShips;     // per-cell ship indices
-    void RebuildBroadphase();
+    std::vector<int> gridAsteroidStart, gridAsteroidItems; // asteroid indices per cell
+    std::vector<int> gridShipStart, gridShipItems;         // ship indices per cell
+    std::vector<int> gridCellOf;                           // scratch: cell per object while binning
+    std::vector<uint64_t> gridRowMask;                     // per row: bit c set if cell c holds anything (first 64 columns)
+    size_t gridAsteroidsBinned = 0;                        // asteroids.size() when last binned
+    std::vector<uint32_t> gridVisitStamp;                  // per cell: last phaser walk that tested it
+    uint32_t gridVisitGen = 0;
+    GridBucket AsteroidsInCell(int cell) const {
+        return { gridAsteroidItems.data() + gridAsteroidStart[cell], gridAsteroidItems.data() + gridAsteroidStart[cell + 1] };
+    }
+    GridBucket ShipsInCell(int cell) const {
+        return { gridShipItems.data() + gridShipStart[cell], gridShipItems.data() + gridShipStart[cell + 1] };
+    }
+    // Collider cache, built alongside the grid: each live ship's world-space
+    // capsule and each asteroid's transform, with world bounding boxes so
+    // queries can reject pairs and wrap images before calling into cute_c2.
+    // Asteroid polys stay in local space: cute_c2 moves the other shape into
+    // the poly's frame anyway, and pre-translated vertices would round
+    // differently and change match outcomes.
+    struct ShipCollider { c2Capsule cap; c2AABB box; };
+    struct AsteroidCollider { c2x tr; c2AABB box; };
+    std::vector<ShipCollider> shipColliders;
+    std::vector<AsteroidCollider> asteroidColliders;
+    bool spatialDirty = true; // something moved since the grid and colliders were built
+    void RebuildBroadphase();  // bin ships and asteroids and build their colliders (once per turn, after physics)
+    void RefreshBroadphase();  // re-bin asteroids only if some were spawned since
     inline int CellIndex(int cx, int cy) const {
         if (gridCols <= 0 || gridRows <= 0) return -1;
         int x = ((cx % gridCols) + gridCols) % gridCols;
@@ -62,7 +125,21 @@ struct AstroArena {
         cx = (int)std::floor(x / (float)gridCellSize);
         cy = (int)std::floor(y / (float)gridCellSize);
     }
-    void CollectNearCells(int cx, int cy, std::vector<int>& outCellIdx) const;
+    // Candidate cells for one query: the 3x3 blocks around up to two positions,
+    // each cell listed once. Lives on the stack so hot loops never allocate.
+    struct NearCells {
+        int cells[18];
+        int count = 0;
+        void Add(int cell) {
+            for (int i = 0; i < count; ++i) {
+                if (cells[i] == cell) return;
+            }
+            cells[count++] = cell;
+        }
+        const int* begin() const { return cells; }
+        const int* end() const { return cells + count; }
+    };
+    void CollectNearCells(int cx, int cy, NearCells& out) const; // adds the 3x3 block around (cx, cy)
     // world queries & actions
     void UpdatePhysics();
     void WrapPosition(float& x, float& y);
@@ -70,7 +147,7 @@ struct AstroArena {
     void TurnDeg(int self, int degrees);
     void FirePhaser(int self);
     void FirePhoton(int self);
-    void Scan(int self);
+    void Scan(int self, bool linear = false); // linear: test every object, the reference for the grid search
     void Signal(int self, int value);
     void TurnToScan(int self);
 
@@ -78,13 +155,29 @@ struct AstroArena {
     bool CircleCollision(float x1, float y1, float r1, float x2, float y2, float r2);
     void HandleCollisions();
     void HandleTorpedoes();
-    void KillShip(ShipState& s, const std::string& message);
+    void KillShip(ShipState& s, const char* reason); // reason is appended to the ship name in the log
     void BreakAsteroid(int asteroidIdx, float pushFromX = -1, float pushFromY = -1);
 
+    // Two-phase turns (AstroMatch::simultaneousTurns). While queueIntents is set,
+    // FirePhaser/FirePhoton/Signal only update the ship's own cooldowns and
+    // signal and record an intent, so scripts never see each other's shots and
+    // may run concurrently. ResolveIntents() then fires everything in ship order
+    // and destroys ships brought to 0 HP only after every shot has landed.
+    struct Intent {
+        bool firePhaser = false;
+        bool firePhoton = false;
+        int signals = 0;
+    };
+    std::vector<Intent> intents; // per ship
+    bool queueIntents = false;
+    void BeginIntents();
+    void ResolveIntents();
+    void PhaserShot(int self);   // the raycast/damage half of FirePhaser
+    void LaunchPhoton(int self); // the spawn half of FirePhoton
+
     void StartTurn();
     void SpawnAsteroids(int count);
     void SpawnAsteroidFromEdge(); // spawn a large asteroid just inside an edge moving inward
-    void SpawnParticleBurst(float x, float y, int count, ImU32 baseColor, float speedScale = 1.0f, float lifeScale = 1.0f, float particleLength = PARTICLE_LENGTH);
 
     int edgeSpawnCooldown = 0; // turns until next edge spawn allowed
 };
@@ -0,0 +1,187 @@
+#include "AstroBatchVM.h"
+#include <algorithm>
+
+static bool SameProgram(const std::vector<AstroInstr>& a, const std::vector<AstroInstr>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].op != b[i].op || a[i].arg != b[i].arg || a[i].power != b[i].power) return false;
+    }
+    return true;
+}
+
+void AstroBatchVM::Clear() {
+    _groups.clear();
+    _roster.clear();
+    _actions.clear();
+}
+
+void AstroBatchVM::Regroup(const std::vector<std::unique_ptr<ShipBase>>& ships) {
+    Clear();
+    for (size_t i = 0; i < ships.size(); ++i) {
+        ShipBase* ship = ships[i].get();
+        if (!ship->linked) ship->Link();
+        _roster.push_back(ship);
+        Group* group = nullptr;
+        for (auto& g : _groups) {
+            if (SameProgram(*g.program, ship->program)) { group = &g; break; }
+        }
+        if (!group) {
+            _groups.emplace_back();
+            group = &_groups.back();
+            group->program = &ship->program;
+        }
+        group->ships.push_back((int)i);
+    }
+    for (auto& g : _groups) {
+        size_t n = g.ships.size();
+        g.pc.resize(n); g.hp.resize(n); g.phaserCd.resize(n); g.photonCd.resize(n);
+        g.fuel.resize(n); g.scanDist.resize(n);
+        g.scanHit.resize(n); g.flag.resize(n); g.active.resize(n);
+    }
+}
+
+void AstroBatchVM::Run(AstroArena& arena, const std::vector<std::unique_ptr<ShipBase>>& ships) {
+    bool regroup = _roster.size() != ships.size();
+    for (size_t i = 0; !regroup && i < ships.size(); ++i) regroup = _roster[i] != ships[i].get();
+    if (regroup) Regroup(ships);
+
+    _actions.clear();
+    for (auto& g : _groups) RunGroup(g, arena);
+
+    // apply deferred actions in ship order, then program order, whatever the grouping
+    // (sorting on seq keeps this stable without stable_sort's temporary buffer)
+    std::sort(_actions.begin(), _actions.end(), [](const Action& a, const Action& b) {
+        return a.ship != b.ship ? a.ship < b.ship : a.seq < b.seq;
+    });
+    for (const auto& a : _actions) {
+        switch (a.op) {
+            case ASTRO_OP_FIRE_PHASER: arena.FirePhaser(a.ship); break;
+            case ASTRO_OP_FIRE_PHOTON: arena.FirePhoton(a.ship); break;
+            case ASTRO_OP_SIGNAL: arena.Signal(a.ship, a.arg); break;
+            default: break;
+        }
+    }
+}
+
+void AstroBatchVM::RunGroup(Group& g, AstroArena& arena) {
+    const std::vector<AstroInstr>& prog = *g.program;
+    const int done = (int)prog.size();
+    const size_t n = g.ships.size();
+
+    // gather; ships dead at the start of the turn do not run
+    for (size_t l = 0; l < n; ++l) {
+        const auto& s = arena.ships[g.ships[l]];
+        g.pc[l] = s.alive ? 0 : done;
+        g.hp[l] = s.hp;
+        g.fuel[l] = s.fuel;
+        g.phaserCd[l] = s.phaser_cooldown;
+        g.photonCd[l] = s.photon_cooldown;
+        g.scanHit[l] = s.scan_hit;
+        g.scanDist[l] = s.scan_dist;
+        g.flag[l] = 0;
+    }
+
+    int* pc = g.pc.data();
+    uint8_t* active = g.active.data();
+    uint8_t* flag = g.flag.data();
+    for (int k = 0; k < done; ++k) {
+        const AstroInstr in = prog[k];
+        uint8_t any = 0;
+        for (size_t l = 0; l < n; ++l) {
+            active[l] = pc[l] == k;
+            any |= active[l];
+        }
+        if (!any) continue;
+
+        switch (in.op) {
+            // conditions: branch-free selects over the SoA columns
+            case ASTRO_OP_IF_SEEN:
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? g.scanHit[l] : flag[l];
+                break;
+            case ASTRO_OP_IF_SCAN_LE: {
+                float range = (float)in.arg;
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.scanHit[l] & (g.scanDist[l] <= range)) : flag[l];
+                break;
+            }
+            case ASTRO_OP_IF_DAMAGED:
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.hp[l] < ASTRO_START_HP) : flag[l];
+                break;
+            case ASTRO_OP_IF_HP_LE:
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.hp[l] <= in.arg) : flag[l];
+                break;
+            case ASTRO_OP_IF_FUEL_LE: {
+                float fuel = (float)in.arg;
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.fuel[l] <= fuel) : flag[l];
+                break;
+            }
+            case ASTRO_OP_IF_CAN_FIRE_PHASER:
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.phaserCd[l] == 0) : flag[l];
+                break;
+            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
+                for (size_t l = 0; l < n; ++l) flag[l] = active[l] ? (uint8_t)(g.photonCd[l] == 0) : flag[l];
+                break;
+
+            // actions on the ship itself run now
+            case ASTRO_OP_THRUST:
+                for (size_t l = 0; l < n; ++l) {
+                    if (!active[l]) continue;
+                    arena.Thrust(g.ships[l], in.power);
+                    g.fuel[l] = arena.ships[g.ships[l]].fuel;
+                }
+                break;
+            case ASTRO_OP_TURN_DEG:
+                for (size_t l = 0; l < n; ++l) {
+                    if (active[l]) arena.TurnDeg(g.ships[l], in.arg);
+                }
+                break;
+            case ASTRO_OP_TURN_TO_SCAN:
+                for (size_t l = 0; l < n; ++l) {
+                    if (active[l]) arena.TurnToScan(g.ships[l]);
+                }
+                break;
+            case ASTRO_OP_SCAN:
+                for (size_t l = 0; l < n; ++l) {
+                    if (!active[l]) continue;
+                    arena.Scan(g.ships[l]);
+                    const auto& s = arena.ships[g.ships[l]];
+                    g.scanHit[l] = s.scan_hit;
+                    g.scanDist[l] = s.scan_dist;
+                }
+                break;
+
+            // actions that reach other ships are deferred; the lane's cooldown
+            // is set now so a later IF_SHIP_CAN_FIRE_* in the script sees it
+            case ASTRO_OP_FIRE_PHASER:
+                for (size_t l = 0; l < n; ++l) {
+                    if (!active[l] || g.phaserCd[l] > 0) continue;
+                    _actions.push_back({ g.ships[l], in.op, 0, (int)_actions.size() });
+                    g.phaserCd[l] = PHASER_COOLDOWN;
+                }
+                break;
+            case ASTRO_OP_FIRE_PHOTON:
+                for (size_t l = 0; l < n; ++l) {
+                    if (!active[l] || g.photonCd[l] > 0) continue;
+                    _actions.push_back({ g.ships[l], in.op, 0, (int)_actions.size() });
+                    g.photonCd[l] = PHOTON_COOLDOWN;
+                }
+                break;
+            case ASTRO_OP_SIGNAL:
+                for (size_t l = 0; l < n; ++l) {
+                    if (active[l]) _actions.push_back({ g.ships[l], in.op, in.arg, (int)_actions.size() });
+                }
+                break;
+            default:
+                break; // WAIT, and the flow control handled below
+        }
+
+        // advance the active lanes
+        int next = k + 1;
+        if (in.op == ASTRO_OP_JUMP_IF_FALSE) {
+            for (size_t l = 0; l < n; ++l) pc[l] = active[l] ? (flag[l] ? next : in.arg) : pc[l];
+        } else {
+            if (in.op == ASTRO_OP_JUMP) next = in.arg;
+            else if (in.op == ASTRO_OP_END) next = done;
+            for (size_t l = 0; l < n; ++l) pc[l] = active[l] ? next : pc[l];
+        }
+    }
+}
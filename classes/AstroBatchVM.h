@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AstroArena.h"
+#include "AstroShip.h"
+
+// ===== AstroBatchVM: lockstep execution of many ships' scripts =====
+// Ships whose linked programs are identical share a group, and each group is
+// run as one sweep over its instructions. Link() only allows forward jumps, so
+// every lane keeps its own pc and instruction k runs for exactly the lanes whose
+// pc is k. Conditions are evaluated over a structure-of-arrays copy of the lane
+// state in plain loops the compiler can vectorize.
+//
+// Ordering differs from the one-ship-at-a-time interpreter. Movement, turning and
+// scans act on the script's own ship immediately and are invisible to the other
+// scripts (scans only read positions, which move in UpdatePhysics). Weapon
+// fire and signals are collected in an action list and applied after every
+// script has run, in ship order, so no script sees another's hits this turn.
+struct AstroBatchVM {
+    void Run(AstroArena& arena, const std::vector<std::unique_ptr<ShipBase>>& ships);
+    void Clear();              // forget the grouping (call when the roster changes)
+    size_t GroupCount() const { return _groups.size(); }
+
+private:
+    struct Group {
+        const std::vector<AstroInstr>* program = nullptr; // shared by every lane
+        std::vector<int> ships;                           // lane -> ship index
+        // per-lane copy of the state conditions read
+        std::vector<int> pc, hp, phaserCd, photonCd;
+        std::vector<float> fuel, scanDist;
+        std::vector<uint8_t> scanHit, flag, active;
+    };
+    struct Action { int ship; int op; int arg; int seq; }; // seq: position in _actions when queued
+
+    void Regroup(const std::vector<std::unique_ptr<ShipBase>>& ships);
+    void RunGroup(Group& g, AstroArena& arena);
+
+    std::vector<Group> _groups;
+    std::vector<const ShipBase*> _roster; // ships the grouping was built for
+    std::vector<Action> _actions;         // deferred weapon fire and signals
+};
@@ -1,6 +1,8 @@
 #include "AstroBots.h"
 #include "../imgui/imgui.h"
-#include <sstream>
+#include "../Application.h"
+#include <chrono>
+#include <fstream>
 #include <iomanip>
 #include <cmath>
 #include <random>
@@ -10,224 +12,8 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-// ===== VM implementation =====
-void ShipBase::Run(int turn) {
-    int pc = 0;
-    bool flag = false;
-    while (pc < (int)code.size()) {
-        int op = code[pc++];
-        switch(op) {
-            case ASTRO_OP_WAIT:
-                break;
-            case ASTRO_OP_THRUST: {
-                int powerInt = code[pc++];
-                float power = powerInt / 10.0f;
-                A->Thrust(id, power);
-                break;
-            }
-            case ASTRO_OP_TURN_DEG: {
-                int degrees = code[pc++];
-                A->TurnDeg(id, degrees);
-                break;
-            }
-            case ASTRO_OP_FIRE_PHASER:
-                A->FirePhaser(id);
-                break;
-            case ASTRO_OP_FIRE_PHOTON:
-                A->FirePhoton(id);
-                break;
-            case ASTRO_OP_SCAN:
-                A->Scan(id);
-                break;
-            case ASTRO_OP_SIGNAL: {
-                int value = code[pc++];
-                A->Signal(id, value);
-                break;
-            }
-            case ASTRO_OP_TURN_TO_SCAN:
-                A->TurnToScan(id);
-                break;
-            case ASTRO_OP_IF_SEEN:
-                pc++; // skip param
-                flag = A->ships[id].scan_hit;
-                break;
-            case ASTRO_OP_IF_SCAN_LE: {
-                int range = code[pc++];
-                flag = (A->ships[id].scan_hit && A->ships[id].scan_dist <= range);
-                break;
-            }
-            case ASTRO_OP_IF_DAMAGED:
-                pc++; // skip param
-                flag = (A->ships[id].hp < ASTRO_START_HP);
-                break;
-            case ASTRO_OP_IF_HP_LE: {
-                int hp = code[pc++];
-                flag = (A->ships[id].hp <= hp);
-                break;
-            }
-            case ASTRO_OP_IF_FUEL_LE: {
-                int fuel = code[pc++];
-                flag = (A->ships[id].fuel <= fuel);
-                break;
-            }
-            case ASTRO_OP_IF_CAN_FIRE_PHASER:
-                pc++; // skip param
-                flag = (A->ships[id].phaser_cooldown == 0);
-                break;
-            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
-                pc++; // skip param
-                flag = (A->ships[id].photon_cooldown == 0);
-                break;
-            case ASTRO_OP_JUMP_IF_FALSE: {
-                int target = code[pc++];
-                if (!flag) pc = target;
-                break;
-            }
-            case ASTRO_OP_JUMP: { 
-                int tgt=code[pc++]; 
-                pc=tgt; break; 
-            }
-            case ASTRO_OP_END:
-                return;
-            default:
-                return;
-        }
-    }
-}
-
-// ===== Sample ship implementations =====
-int HunterShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        // Always turn toward and pursue what we see
-        TURN_TO_SCAN();
-        IF_SCAN_LE(500) {  // within phaser range: shoot
-            IF_SHIP_CAN_FIRE_PHASER() {
-                FIRE_PHASER();
-            }
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();
-            }
-        }
-        THRUST(2);  // close distance if not in range
-    } ELSE() {
-        THRUST(4);
-    }
-    IF_SHIP_FUEL_LE(40) {
-        SCAN();
-        IF_SCAN_LE(300) {  // Increased from 100 - look for fuel further away
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int DroneShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
-            // Thrust away from threat
-            THRUST(3);
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();  // Fire while retreating
-            }
-        }
-    }
-    IF_SHIP_HP_LE(6) {  // Emergency threshold
-        THRUST(2);
-    }
-    IF_SHIP_FUEL_LE(35) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int MinerShip::SetupShip() {
-    // Move toward scanned objects and fire when close
-    SCAN();
-    IF_SEEN() {
-        TURN_TO_SCAN();
-        THRUST(2);
-        IF_SCAN_LE(150) {  // close range work
-            IF_SHIP_CAN_FIRE_PHASER() {
-                FIRE_PHASER();
-            }
-        }
-    } ELSE() {
-        THRUST(4);
-    }
-    IF_SHIP_DAMAGED() {
-        SCAN();
-        IF_SEEN() {
-            IF_SCAN_LE(350) {  // Increased from 200 - flee earlier
-                THRUST(3);
-            }
-        }
-    }
-    return Finalize();
-}
-
-int GraemeShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
-            // Thrust away from threat
-            THRUST(3);
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();  // Fire while retreating
-            }
-        }
-    }
-    IF_SHIP_HP_LE(6) {  // Emergency threshold
-        THRUST(2);
-    }
-    IF_SHIP_FUEL_LE(35) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
-int BeepBoopShip::SetupShip() {
-    SCAN();
-    IF_SEEN() {
-        TURN_TO_SCAN();
-        IF_SCAN_LE(450) {
-            // Thrust away from threat
-            THRUST(3);
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();  // Fire while retreating
-            }
-            IF_SHIP_CAN_FIRE_PHOTON() {
-                FIRE_PHOTON();
-            }
-        }
-    }
-    IF_SHIP_HP_LE(6) {  // Emergency threshold
-        THRUST(2);
-    }
-    IF_SHIP_FUEL_LE(35) {
-        SCAN();
-        IF_SCAN_LE(200) {  // Increased from 100
-            TURN_TO_SCAN();
-            THRUST(2);
-        }
-    }
-    return Finalize();
-}
-
 // ===== AstroBots game implementation =====
 AstroBots::AstroBots() {
-    _currentTurn = 0;
-    _gameRunning = false;
 }
 
 AstroBots::~AstroBots() {
@@ -235,11 +21,9 @@ AstroBots::~AstroBots() {
 
 std::vector<std::unique_ptr<ShipBase>> AstroBots::makeShips() {
     std::vector<std::unique_ptr<ShipBase>> v;
-    v.emplace_back(std::make_unique<HunterShip>());
-    v.emplace_back(std::make_unique<DroneShip>());
-    v.emplace_back(std::make_unique<MinerShip>());
-    v.emplace_back(std::make_unique<GraemeShip>());
-    v.emplace_back(std::make_unique<BeepBoopShip>());
+    for (const auto& e : AstroShipRoster()) {
+        v.emplace_back(e.make());
+    }
     return v;
 }
 
@@ -248,66 +32,14 @@ void AstroBots::setUpBoard() {
     _gameOptions.rowX = (int)ASTROBOTS_W;
     _gameOptions.rowY = (int)ASTROBOTS_H;
 
-    _ships = makeShips();
-    _arena.ships.resize(_ships.size());
     _logLines.clear();
 
-    // Validate scripts & inject arena refs
-    ImU32 shipColors[] = {
-        IM_COL32(255, 80, 80, 255),   // Red
-        IM_COL32(80, 255, 80, 255),   // Green
-        IM_COL32(80, 180, 255, 255),  // Blue
-        IM_COL32(255, 255, 80, 255),  // Yellow
-        IM_COL32(255, 80, 255, 255),  // Magenta
-        IM_COL32(80, 255, 255, 255),   // Cyan
-        IM_COL32(255, 160, 0, 255),    // Orange
-        IM_COL32(128, 0, 128, 255)     // Purple
-    };
-
-    // Hook up logger
-    _arena.log = [this](const std::string& line) {
-        _logLines.push_back(line);
-        if (_logLines.size() > 500) {
-            _logLines.erase(_logLines.begin(), _logLines.begin() + (_logLines.size() - 500));
-        }
-    };
-
-    for (size_t i = 0; i < _ships.size(); ++i) {
-        int cost = _ships[i]->SetupShip();
-        // log the ship setup cost and show the name, highlight if it exceeds the limit
-        std::string nm = _ships[i] ? _ships[i]->name : std::string("Ship");
-        std::string line = nm + " script cost " + std::to_string(cost) + "/" + std::to_string(ASTRO_MAX_SCRIPT_COST);
-        if (cost > ASTRO_MAX_SCRIPT_COST) line += " (EXCEEDS LIMIT)";
-        _logLines.push_back(line);
-        if (_logLines.size() > 500) {
-            _logLines.erase(_logLines.begin(), _logLines.begin() + (_logLines.size() - 500));
-        }
-        _arena.ships[i].ship = _ships[i].get();
-        _arena.ships[i].color = shipColors[i % 6];
-        _ships[i]->A = &_arena;
-        _ships[i]->id = (int)i;
-    }
-
-    // Spawn ships in a circle around the center
-    float centerX = ASTROBOTS_W / 2.0f;
-    float centerY = ASTROBOTS_H / 2.0f;
-    float spawnRadius = 300.0f;
-
-    for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        float angle = (float)i / _ships.size() * 2.0f * M_PI;
-        _arena.ships[i].x = centerX + std::cos(angle) * spawnRadius;
-        _arena.ships[i].y = centerY + std::sin(angle) * spawnRadius;
-        _arena.ships[i].angle = angle * 180.0f / M_PI;
-        _arena.ships[i].targetAngle = _arena.ships[i].angle;
-        _arena.ships[i].vx = 0;
-        _arena.ships[i].vy = 0;
-    }
-
-    // Spawn asteroids
-    _arena.SpawnAsteroids(NUM_INITIAL_ASTEROIDS);
-
-    _currentTurn = 0;
-    _gameRunning = true;
+    std::random_device rd;
+    uint64_t seed = ((uint64_t)rd() << 32) | rd();
+    _sim.Start(makeShips(), seed);
+    _frame = nullptr;
+    _lastTurn = 0;
+    _seekTurn = 0;
 
     startGame();
 }
@@ -330,7 +62,25 @@ ImVec2 AstroBots::WorldToScreen(float x, float y) {
     return ImVec2(screenX, screenY);
 }
 
-void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, ImVec2 offset) {
+// Step from `prev` towards `cur` by t, taking the short way across a wrapped edge
+static float LerpWrapped(float prev, float cur, float size, float t) {
+    float d = cur - prev;
+    if (d > size * 0.5f) d -= size;
+    else if (d < -size * 0.5f) d += size;
+    return cur - d * (1.0f - t);
+}
+
+AstroArena::ShipState AstroBots::InterpolatedShip(size_t i) const {
+    AstroArena::ShipState s = _frame->ships[i];
+    if (_renderAlpha >= 1.0f || i >= _frame->prevShips.size()) return s;
+    const AstroArena::ShipState& p = _frame->prevShips[i];
+    s.x = LerpWrapped(p.x, s.x, ASTROBOTS_W, _renderAlpha);
+    s.y = LerpWrapped(p.y, s.y, ASTROBOTS_H, _renderAlpha);
+    s.angle = LerpWrapped(p.angle, s.angle, 360.0f, _renderAlpha);
+    return s;
+}
+
+void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, const char* name, ImVec2 offset) {
     if (!ship.alive) return;
 
     ImVec2 pos = WorldToScreen(ship.x, ship.y);
@@ -381,13 +131,13 @@ void AstroBots::DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship
     drawList->AddRectFilled(fuelTL, fuelFillBR, IM_COL32(255, 200, 64, 230));
 
     // Name label
-    const char* label = ship.ship ? ship.ship->name.c_str() : "Ship";
+    const char* label = name;
     ImVec2 textSize = ImGui::CalcTextSize(label);
     ImVec2 textPos(pos.x - textSize.x / 2, pos.y + 20);
     drawList->AddText(textPos, IM_COL32(255, 255, 255, 255), label);
 }
 
-void AstroBots::DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, ImVec2 offset) {
+void AstroBots::DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, const c2Poly& shape, ImVec2 offset) {
     if (!asteroid.alive) return;
 
     ImVec2 pos = WorldToScreen(asteroid.x, asteroid.y);
@@ -395,10 +145,11 @@ void AstroBots::DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, ImV
     pos.y += offset.y;
 
     // Draw asteroid as polygon
-    if (asteroid.shape.size() < 3) return;
+    if (shape.count < 3) return;
 
     std::vector<ImVec2> points;
-    for (const auto& v : asteroid.shape) {
+    for (int vi = 0; vi < shape.count; ++vi) {
+        const c2v& v = shape.verts[vi];
         ImVec2 p = WorldToScreen(asteroid.x + v.x, asteroid.y + v.y);
         p.x += offset.x; p.y += offset.y;
         points.push_back(p);
@@ -473,9 +224,8 @@ void AstroBots::DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam, ImV
     drawList->AddLine(p1, p2, glowColor, 6.0f);
 }
 
-void AstroBots::DrawParticles(ImDrawList* drawList, const std::vector<Particle>& particles, ImVec2 offset) {
+void AstroBots::DrawParticles(ImDrawList* drawList, const AstroParticles& particles, ImVec2 offset) {
     for (const auto& p : particles) {
-        if (!p.alive) continue;
         ImVec2 pos = WorldToScreen(p.x, p.y);
         pos.x += offset.x; pos.y += offset.y;
 
@@ -521,7 +271,7 @@ void AstroBots::DrawParticles(ImDrawList* drawList, const std::vector<Particle>&
     }
 }
 
-void AstroBots::DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebrisSegment>& debris, ImVec2 offset) {
+void AstroBots::DrawShipDebris(ImDrawList* drawList, const AstroDebris& debris, ImVec2 offset) {
     for (const auto& d : debris) {
         if (!d.alive) continue;
         ImVec2 p1 = WorldToScreen(d.x1, d.y1);
@@ -551,9 +301,32 @@ void AstroBots::DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebri
     }
 }
 
+void AstroBots::SetClock(const AstroClock& settings, bool interpolate) {
+    _clock = settings;
+    _interpolate = interpolate;
+    _sim.SetClock(settings);
+}
+
 void AstroBots::drawFrame() {
     Game::drawFrame();
 
+    // take the newest frame the simulation thread has published, and catch up
+    // on the turns it ran since the last one
+    _frame = &_sim.Acquire();
+    _sim.DrainLog(_logLines);
+    if (_logLines.size() > 500) {
+        _logLines.erase(_logLines.begin(), _logLines.begin() + (_logLines.size() - 500));
+    }
+    if (_frame->turn != _lastTurn) {
+        _lastTurn = _frame->turn;
+        endTurn();
+    }
+    _renderAlpha = 1.0f;
+    if (_interpolate && !_clock.turbo && _frame->running) {
+        double since = std::chrono::duration<double>(std::chrono::steady_clock::now() - _frame->steppedAt).count();
+        _renderAlpha = (float)std::clamp(since * _clock.tickRate, 0.0, 1.0);
+    }
+
     //ImGui::Begin("AstroBotsView");
 
     ImDrawList* drawList = ImGui::GetWindowDrawList();
@@ -562,10 +335,12 @@ void AstroBots::drawFrame() {
     ImVec2 contentMax = ImGui::GetWindowContentRegionMax();
     ImVec2 origin = ImVec2(windowPos.x + contentMin.x, windowPos.y + contentMin.y);
     ImVec2 size = ImVec2(contentMax.x - contentMin.x, contentMax.y - contentMin.y);
-    // Update arena render scale for effects that need screen-size awareness
+    // Render scale for effects that need screen-size awareness (ship debris)
     float scaleX = size.x / ASTROBOTS_W;
     float scaleY = size.y / ASTROBOTS_H;
-    _arena.renderScale = (scaleX < scaleY) ? scaleX : scaleY;
+    _renderScale = (scaleX < scaleY) ? scaleX : scaleY;
+    _sim.SetRenderScale(_renderScale);
+    const AstroRenderFrame& frame = *_frame;
 
     // Draw space background in content region
     drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y),
@@ -595,30 +370,105 @@ void AstroBots::drawFrame() {
     borderBR.x += origin.x; borderBR.y += origin.y;
     drawList->AddRect(borderTL, borderBR, IM_COL32(100, 100, 150, 255), 0.0f, 0, 3.0f);
 
+    // during a fast-forward the match is not drawn at all, only its progress
+    if (frame.fastForwarding) {
+        DrawFastForward(origin, size);
+    } else {
+        DrawWorld(drawList, origin);
+    }
+
+    ImGui::End();
+
+    // Logging window
+    ImGui::Begin("AstroBots Log");
+    if (ImGui::Button("Clear")) {
+        _logLines.clear();
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto-scroll", &_logAutoScroll);
+    ImGui::Separator();
+    ImGui::Text("Turn: %d / %d", frame.turn, ASTRO_MAX_TURNS);
+    ImGui::Text("Seed: %llu", (unsigned long long)frame.seed);
+    ImGui::Text("Last batch: %d turns (%lld dropped)", frame.ticks, frame.dropped);
+    ImGui::Text("Replay: %d turns, %zu bytes", frame.replayTurns, frame.replayBytes);
+    ImGui::SameLine();
+    if (ImGui::Button("Save Replay")) {
+        SaveReplay();
+    }
+    ImGui::BeginDisabled(frame.fastForwarding);
+    ImGui::SliderInt("Seek", &_seekTurn, 0, std::max(0, frame.replayTurns));
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        SeekTo(_seekTurn);
+    } else if (!ImGui::IsItemActive()) {
+        _seekTurn = frame.turn;
+    }
+    ImGui::EndDisabled();
+    ImGui::BeginDisabled(!frame.running || frame.fastForwarding);
+    ImGui::SetNextItemWidth(120.0f);
+    ImGui::InputInt("##ff_turns", &_fastForwardTurns, 100, 1000);
+    _fastForwardTurns = std::clamp(_fastForwardTurns, 1, ASTRO_MAX_TURNS);
+    ImGui::SameLine();
+    if (ImGui::Button("Fast-forward")) {
+        _sim.FastForward(_fastForwardTurns);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("To end")) {
+        _sim.FastForward(0);
+    }
+    ImGui::EndDisabled();
+    ImGui::Separator();
+    ImGui::BeginChild("scroll_region", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+    for (const auto& line : _logLines) {
+        ImGui::TextUnformatted(line.c_str());
+    }
+    if (_logAutoScroll) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    ImGui::EndChild();
+    //ImGui::End();
+}
+
+void AstroBots::DrawWorld(ImDrawList* drawList, ImVec2 origin) {
+    const AstroRenderFrame& frame = *_frame;
+
+    // Between turns, entities are drawn part way from their previous state:
+    // asteroids drift at constant velocity, torpedoes keep their previous
+    // position and ships are kept from before the last Step()
+    const float back = 1.0f - _renderAlpha;
+    const std::vector<AstroAsteroidShape>& asteroidShapes = AstroAsteroidShapes();
+
     // Draw asteroids
-    for (const auto& a : _arena.asteroids) {
-        DrawAsteroid(drawList, a, origin);
+    for (const auto& a : frame.asteroids) {
+        if (a.shape < 0) continue;
+        Asteroid at = a;
+        at.x -= a.vx * back;
+        at.y -= a.vy * back;
+        DrawAsteroid(drawList, at, asteroidShapes[a.shape].poly, origin);
     }
 
     // Draw phaser beams (drawn first so they appear behind torpedoes and ships)
-    for (const auto& beam : _arena.phaserBeams) {
+    for (const auto& beam : frame.phaserBeams) {
         DrawPhaserBeam(drawList, beam, origin);
     }
 
     // Draw particles (hits, sparks)
-    DrawParticles(drawList, _arena.particles, origin);
+    DrawParticles(drawList, frame.particles, origin);
 
     // Draw ship debris segments
-    DrawShipDebris(drawList, _arena.shipDebris, origin);
+    DrawShipDebris(drawList, frame.shipDebris, origin);
 
     // Draw torpedoes
-    for (const auto& t : _arena.torpedoes) {
-        DrawTorpedo(drawList, t, origin);
+    for (const auto& t : frame.torpedoes) {
+        PhotonTorpedo tt = t;
+        tt.x = LerpWrapped(t.prevX, t.x, ASTROBOTS_W, _renderAlpha);
+        tt.y = LerpWrapped(t.prevY, t.y, ASTROBOTS_H, _renderAlpha);
+        DrawTorpedo(drawList, tt, origin);
     }
 
     // Draw ships
-    for (const auto& s : _arena.ships) {
-        DrawShip(drawList, s, origin);
+    for (size_t i = 0; i < frame.ships.size(); ++i) {
+        const char* name = i < frame.shipNames.size() ? frame.shipNames[i].c_str() : "Ship";
+        DrawShip(drawList, InterpolatedShip(i), name, origin);
     }
 
     // Debug: collision boundaries
@@ -628,28 +478,27 @@ void AstroBots::drawFrame() {
 
     // Draw HUD
     DrawHUD();
+}
 
-    ImGui::End();
+void AstroBots::DrawFastForward(ImVec2 origin, ImVec2 size) {
+    const AstroRenderFrame& frame = *_frame;
+    int span = std::max(1, frame.ffTarget - frame.ffFrom);
+    float progress = std::clamp((float)(frame.turn - frame.ffFrom) / (float)span, 0.0f, 1.0f);
 
-    // Logging window
-    ImGui::Begin("AstroBots Log");
-    if (ImGui::Button("Clear")) {
-        _logLines.clear();
-    }
-    ImGui::SameLine();
-    ImGui::Checkbox("Auto-scroll", &_logAutoScroll);
-    ImGui::Separator();
-    ImGui::Text("Turn: %d / %d", _currentTurn, ASTRO_MAX_TURNS);
-    ImGui::Separator();
-    ImGui::BeginChild("scroll_region", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
-    for (const auto& line : _logLines) {
-        ImGui::TextUnformatted(line.c_str());
-    }
-    if (_logAutoScroll) {
-        ImGui::SetScrollHereY(1.0f);
+    const float width = 320.0f;
+    ImVec2 windowPos = ImGui::GetWindowPos();
+    ImGui::SetCursorPos(ImVec2(origin.x - windowPos.x + (size.x - width) * 0.5f,
+                               origin.y - windowPos.y + size.y * 0.5f - 40.0f));
+    ImGui::BeginGroup();
+    ImGui::Text("Fast-forwarding to turn %d", frame.ffTarget);
+    char overlay[32];
+    std::snprintf(overlay, sizeof(overlay), "turn %d", frame.turn);
+    ImGui::ProgressBar(progress, ImVec2(width, 0.0f), overlay);
+    ImGui::Text("%.0f turns/s", frame.ffTurnsPerSec);
+    if (ImGui::Button("Cancel")) {
+        _sim.CancelFastForward();
     }
-    ImGui::EndChild();
-    //ImGui::End();
+    ImGui::EndGroup();
 }
 
 void AstroBots::DrawHUD() {
@@ -659,9 +508,10 @@ void AstroBots::DrawHUD() {
     ImGui::Separator();
     ImGui::Checkbox("Show Colliders", &_showColliders);
     ImGui::Separator();
-    for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        const auto& s = _arena.ships[i];
-        const char* name = s.ship ? s.ship->name.c_str() : "Ship";
+    const AstroRenderFrame& frame = *_frame;
+    for (size_t i = 0; i < frame.ships.size(); ++i) {
+        const auto& s = frame.ships[i];
+        const char* name = i < frame.shipNames.size() ? frame.shipNames[i].c_str() : "Ship";
         if (s.alive) {
             ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.5f, 1.0f),
                              "%s: HP=%d Fuel=%.0f", name, s.hp, s.fuel);
@@ -671,8 +521,10 @@ void AstroBots::DrawHUD() {
         }
     }
     ImGui::Separator();
-    ImGui::Text("Asteroids: %d", (int)_arena.asteroids.size());
-    ImGui::Text("Torpedoes: %d", (int)_arena.torpedoes.size());
+    ImGui::Text("Asteroids: %d", (int)frame.asteroids.size());
+    ImGui::Text("Torpedoes: %d", (int)frame.torpedoes.size());
+    ImGui::Text("Particles: %d / %d (%llu dropped)", (int)frame.particles.Size(), (int)frame.particles.Capacity(),
+                (unsigned long long)frame.particles.dropped);
     ImGui::EndGroup();
 }
 
@@ -685,10 +537,11 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     ImU32 torpColor = IM_COL32(80, 180, 255, 200);
     ImU32 sweepColor = IM_COL32(80, 80, 255, 140);
 
-    const float scale = _arena.renderScale;
+    const AstroRenderFrame& frame = *_frame;
+    const float scale = _renderScale;
 
     // Ships as capsules
-    for (const auto& s : _arena.ships) {
+    for (const auto& s : frame.ships) {
         if (!s.alive) continue;
         // Match capsule used in collisions
         const float halfLen = 15.0f;
@@ -710,12 +563,14 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     }
 
     // Asteroids as collision polys (local verts translated to world)
-    for (const auto& a : _arena.asteroids) {
-        if (!a.alive || a.shape.size() < 3) continue;
+    for (const auto& a : frame.asteroids) {
+        if (!a.alive || a.shape < 0) continue;
+        const c2Poly& poly = AstroAsteroidShapes()[a.shape].poly;
         // Build points
         std::vector<ImVec2> pts;
-        pts.reserve(a.shape.size());
-        for (const auto& v : a.shape) {
+        pts.reserve(poly.count);
+        for (int vi = 0; vi < poly.count; ++vi) {
+            const c2v& v = poly.verts[vi];
             ImVec2 p = WorldToScreen(a.x + v.x, a.y + v.y);
             p.x += offset.x; p.y += offset.y;
             pts.push_back(p);
@@ -735,7 +590,7 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     }
 
     // Torpedoes as circles + sweep segment (prev->curr)
-    for (const auto& t : _arena.torpedoes) {
+    for (const auto& t : frame.torpedoes) {
         if (!t.alive) continue;
         float rad = 5.0f * scale;
         ImVec2 p = WorldToScreen(t.x, t.y);
@@ -748,69 +603,13 @@ void AstroBots::DrawDebugColliders(ImDrawList* drawList, ImVec2 offset) {
     }
 }
 
+// The simulation thread steps the match; this runs on the UI thread once per
+// frame that shows a new turn
 void AstroBots::endTurn() {
-    if (!_gameRunning) return;
-
-    _currentTurn++;
-
-    if (_currentTurn > ASTRO_MAX_TURNS) {
-        _gameRunning = false;
-        return;
-    }
-
-    // Start turn (reset cooldowns, etc.)
-    _arena.StartTurn();
-
-    // Each alive ship takes a turn
-    for (size_t i = 0; i < _arena.ships.size(); ++i) {
-        if (!_arena.ships[i].alive) continue;
-        _ships[i]->Run(_currentTurn);
-    }
-
-    // Update physics
-    _arena.UpdatePhysics();
-
-    // Handle collisions
-    _arena.HandleCollisions();
-    _arena.HandleTorpedoes();
-
-    // After handling torpedo collisions based on unwrapped motion, wrap torpedoes
-    for (auto& t : _arena.torpedoes) {
-        if (t.alive) {
-            _arena.WrapPosition(t.x, t.y);
-        }
-    }
-
-    // Clean up dead torpedoes, asteroids, and phaser beams
-    _arena.torpedoes.erase(
-        std::remove_if(_arena.torpedoes.begin(), _arena.torpedoes.end(),
-                      [](const PhotonTorpedo& t) { return !t.alive; }),
-        _arena.torpedoes.end()
-    );
-    _arena.asteroids.erase(
-        std::remove_if(_arena.asteroids.begin(), _arena.asteroids.end(),
-                      [](const Asteroid& a) { return !a.alive; }),
-        _arena.asteroids.end()
-    );
-    _arena.phaserBeams.erase(
-        std::remove_if(_arena.phaserBeams.begin(), _arena.phaserBeams.end(),
-                      [](const PhaserBeam& b) { return !b.alive; }),
-        _arena.phaserBeams.end()
-    );
-
-    // Maintain asteroid population by spawning from edges with a cooldown
-    if (_arena.edgeSpawnCooldown > 0) {
-        _arena.edgeSpawnCooldown--;
-    }
-    if (_arena.asteroids.size() < NUM_INITIAL_ASTEROIDS && _arena.edgeSpawnCooldown == 0) {
-        _arena.SpawnAsteroidFromEdge();
-        _arena.edgeSpawnCooldown = 60; // spawn at most every ~2 seconds (at 30Hz)
-    }
-
     // Update camera to follow action (center on average ship position)
     float avgX = 0, avgY = 0;
     int aliveCount = 0;
-    for (const auto& s : _arena.ships) {
+    for (const auto& s : _frame->ships) {
         if (s.alive) {
             avgX += s.x;
             avgY += s.y;
@@ -822,16 +621,42 @@ void AstroBots::endTurn() {
         _cameraY = avgY / aliveCount;
     }
 
-    // Check if game over
-    int alive = 0;
-    for (const auto& s : _arena.ships) {
-        if (s.alive) alive++;
-    }
-    if (alive <= 1) {
-        _gameRunning = false;
-    }
+    // The binary replay stands in for Game's per-turn Turn/stateString() history,
+    // so skip Game::endTurn() and only do its bookkeeping
+    _gameOptions.currentTurnNo = _frame->turn;
+    ClassGame::EndOfTurn();
+}
 
-    Game::endTurn();
+void AstroBots::SaveReplay() {
+    _sim.Post([this] {
+        AstroMatch& match = _sim.match;
+        std::string path = "astrobots_" + std::to_string(match.arena.matchSeed) + ".replay";
+        std::ofstream out(path, std::ios::binary);
+        if (out) {
+            out.write((const char*)_sim.replay.Bytes().data(), (std::streamsize)_sim.replay.Size());
+        }
+        match.arena.log(out ? "Replay saved to " + path : "Could not write " + path);
+    });
+}
+
+void AstroBots::SeekTo(int turn) {
+    // a fast-forward would carry on toward its old target from the new turn
+    _sim.CancelFastForward();
+    _sim.Post([this, turn] {
+        AstroMatch& match = _sim.match;
+        AstroReplayReader reader;
+        std::string error;
+        bool ok = reader.Load(_sim.replay.Bytes(), error);
+        if (ok) {
+            // re-simulate silently; the log already holds these turns
+            auto log = std::move(match.arena.log);
+            match.arena.log = nullptr;
+            ok = AstroReplaySeek(reader, turn, match, error);
+            match.arena.log = std::move(log);
+            _sim.Restarted();
+        }
+        match.arena.log(ok ? "Seeked to turn " + std::to_string(match.turn) : "Seek failed: " + error);
+    });
 }
 
 bool AstroBots::actionForEmptyHolder(BitHolder &holder) {
@@ -847,61 +672,55 @@ bool AstroBots::canBitMoveFromTo(Bit &bit, BitHolder &src, BitHolder &dst) {
 }
 
 void AstroBots::stopGame() {
-    _gameRunning = false;
-
-    // Clear all arena state
-    _arena.torpedoes.clear();
-    _arena.phaserBeams.clear();
-    _arena.asteroids.clear();
-    _arena.signals.clear();
-    _arena.ships.clear();
-    _arena.particles.clear();
-
-    // Clear ship scripts
-    _ships.clear();
+    _sim.Call([this] {
+        _sim.match.Clear();
+        _sim.effects.Clear();
+        _sim.prevShips.clear();
+    });
+    _sim.DrainLog(_logLines);
     _logLines.clear();
 }
 
 Player* AstroBots::checkForWinner() {
-    if (!_gameRunning) {
-        int alive = 0;
-        for (size_t i = 0; i < _arena.ships.size(); ++i) {
-            if (_arena.ships[i].alive) {
-                alive++;
-            }
-        }
-        if (alive == 1) {
-            return getPlayerAt(0);
-        }
+    if (_frame && _frame->winner >= 0) {
+        return getPlayerAt(0);
     }
     return nullptr;
 }
 
 bool AstroBots::checkForDraw() {
-    if (!_gameRunning && _currentTurn >= ASTRO_MAX_TURNS) {
-        int alive = 0;
-        for (const auto& s : _arena.ships) {
-            if (s.alive) alive++;
-        }
-        return alive > 1;
-    }
-    return false;
+    return _frame && _frame->draw;
 }
 
 std::string AstroBots::initialStateString() {
     return stateString();
 }
 
+// The state string is a binary AstroSnapshot of the whole arena, so a match can
+// be saved and restored (or forked) mid-game
 std::string AstroBots::stateString() {
-    std::stringstream ss;
-    ss << _currentTurn << ";";
-    for (const auto& s : _arena.ships) {
-        ss << s.x << "," << s.y << "," << s.vx << "," << s.vy << ","
-           << s.angle << "," << s.hp << "," << s.fuel << "," << s.alive << ";";
-    }
-    return ss.str();
+    std::vector<uint8_t> bytes;
+    _sim.Call([&] { AstroSaveSnapshot(_sim.match, bytes); });
+    return std::string((const char*)bytes.data(), bytes.size());
 }
 
 void AstroBots::setStateString(const std::string &s) {
-    // Not fully implemented - would need to restore full state
+    _sim.Call([&] {
+        AstroMatch& match = _sim.match;
+        uint64_t seed = match.arena.matchSeed;
+        std::string error;
+        if (!AstroLoadSnapshot((const uint8_t*)s.data(), s.size(), match, error)) {
+            match.arena.log("Restore failed: " + error);
+            return;
+        }
+        _sim.Restarted();
+        // keep recording into the current replay when the snapshot came from it
+        if (match.arena.matchSeed != seed || match.turn > _sim.replay.LastTurn() + 1) {
+            std::vector<std::string> names;
+            for (const auto& ship : match.ships) names.push_back(ship->name);
+            _sim.replay.Begin(match, names);
+        }
+        _seekTurn = match.turn;
+        match.arena.log("Restored turn " + std::to_string(match.turn));
+    });
 }
@@ -10,114 +10,13 @@
 
 #include "AstroTypes.h"
 #include "AstroArena.h"
-
-// ===== ShipBase: tiny VM with space combat Domain-Specific Language =====
-struct ShipBase {
-    std::vector<int> code;
-    std::vector<float> floatParams; // for storing float parameters like thrust power
-    int script_cost = 0;
-    std::string name = "Ship";
-    struct IfContext { int jumpIfFalseIndex=-1; int jumpToEndIndex=-1; };
-    std::vector<IfContext> _ifCtx;
-
-   struct IfBlock {
-        ShipBase* self; IfBlock(ShipBase* s, AstroOpCode cond, int param): self(s){
-            self->code.push_back(cond); self->code.push_back(param);
-            self->code.push_back(ASTRO_OP_JUMP_IF_FALSE); self->code.push_back(0); // placeholder
-            ShipBase::IfContext ctx; ctx.jumpIfFalseIndex = (int)self->code.size()-1; ctx.jumpToEndIndex = -1;
-            self->_ifCtx.push_back(ctx);
-        }
-        ~IfBlock(){
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                // If no ELSE() was emitted, patch false-jump to end of IF block
-                if (ctx.jumpToEndIndex == -1){
-                    self->code[ctx.jumpIfFalseIndex] = (int)self->code.size();
-                }
-                self->_ifCtx.pop_back();
-            }
-        }
-        explicit operator bool() const { return true; }
-    };
-    struct ElseBlock {
-        ShipBase* self;
-        ElseBlock(ShipBase* s): self(s){
-            // Begin ELSE: jump over else body, patch IF's false to here
-            self->code.push_back(ASTRO_OP_JUMP); self->code.push_back(0); // placeholder to end of else
-            int jumpToEndIdx = (int)self->code.size()-1;
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                self->code[ctx.jumpIfFalseIndex] = (int)self->code.size(); // start of ELSE
-                ctx.jumpToEndIndex = jumpToEndIdx;
-            }
-        }
-        ~ElseBlock(){
-            if (!self->_ifCtx.empty()){
-                ShipBase::IfContext &ctx = self->_ifCtx.back();
-                if (ctx.jumpToEndIndex != -1){
-                    self->code[ctx.jumpToEndIndex] = (int)self->code.size(); // end of ELSE
-                }
-            }
-        }
-        explicit operator bool() const { return true; }
-    };
-
-    // DSL: bot coders will use these in SetupShip()
-    #define THRUST(P)    do{ code.push_back(ASTRO_OP_THRUST); code.push_back((int)((P)*10)); script_cost += ASTRO_COST_THRUST; }while(0)
-    #define TURN_DEG(D)  do{ code.push_back(ASTRO_OP_TURN_DEG); code.push_back((D)); script_cost += ASTRO_COST_TURN; }while(0)
-    #define FIRE_PHASER() do{ code.push_back(ASTRO_OP_FIRE_PHASER); script_cost += ASTRO_COST_PHASER; }while(0)
-    #define FIRE_PHOTON() do{ code.push_back(ASTRO_OP_FIRE_PHOTON); script_cost += ASTRO_COST_PHOTON; }while(0)
-    #define SCAN()       do{ code.push_back(ASTRO_OP_SCAN); script_cost += ASTRO_COST_SCAN; }while(0)
-    #define SIGNAL(V)    do{ code.push_back(ASTRO_OP_SIGNAL); code.push_back((V)); script_cost += ASTRO_COST_SIGNAL; }while(0)
-    #define WAIT_()      do{ code.push_back(ASTRO_OP_WAIT); script_cost += ASTRO_COST_WAIT; }while(0)
-    #define TURN_TO_SCAN() do{ code.push_back(ASTRO_OP_TURN_TO_SCAN); script_cost += ASTRO_COST_TURN; }while(0)
-
-    #define IF_SEEN()      if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SEEN, 0})
-    #define IF_SCAN_LE(R)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SCAN_LE, (R)})
-    #define IF_SHIP_DAMAGED()   if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_DAMAGED, 0})
-    #define IF_SHIP_HP_LE(N)    if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_HP_LE, (N)})
-    #define IF_SHIP_FUEL_LE(N)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_FUEL_LE, (N)})
-    #define IF_SHIP_CAN_FIRE_PHASER()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHASER, 0})
-    #define IF_SHIP_CAN_FIRE_PHOTON()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHOTON, 0})
-    #define ELSE() else if (ElseBlock _cb##__LINE__{this})
-
-    int Finalize() { code.push_back(ASTRO_OP_END); return script_cost; }
-
-    // hooks provided by Arena at runtime
-    AstroArena* A = nullptr;
-    int id = -1;
-    virtual int SetupShip() = 0; // bot coders will implement this
-    virtual ~ShipBase() = default;
-
-    // interpreter
-    void Run(int turn);
-};
-
-// ===== Sample ships =====
-struct HunterShip : ShipBase {
-    HunterShip() { name = "Hunter"; }
-    int SetupShip() override;
-};
-
-struct DroneShip : ShipBase {
-    DroneShip() { name = "Drone"; }
-    int SetupShip() override;
-};
-
-struct MinerShip : ShipBase {
-    MinerShip() { name = "Miner"; }
-    int SetupShip() override;
-};
-
-struct GraemeShip : ShipBase {
-    GraemeShip() { name = "Graeme"; }
-    int SetupShip() override;
-};
-
-struct BeepBoopShip : ShipBase {
-    BeepBoopShip() { name = "BeepBoop";}
-    int SetupShip() override;
-};
+#include "AstroShip.h"
+#include "AstroMatch.h"
+#include "AstroReplay.h"
+#include "AstroSnapshot.h"
+#include "AstroEffects.h"
+#include "AstroClock.h"
+#include "AstroSimThread.h"
 
 // ===== Main game class =====
 class AstroBots : public Game
@@ -145,26 +44,42 @@ public:
 
     Grid* getGrid() override { return nullptr; } // No grid in AstroBots
 
+    // how the simulation thread schedules turns, and whether frames between
+    // turns are interpolated
+    void SetClock(const AstroClock& settings, bool interpolate);
+
 private:
-    void DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, ImVec2 offset);
-    void DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, ImVec2 offset);
+    void DrawShip(ImDrawList* drawList, const AstroArena::ShipState& ship, const char* name, ImVec2 offset);
+    void DrawAsteroid(ImDrawList* drawList, const Asteroid& asteroid, const c2Poly& shape, ImVec2 offset);
     void DrawTorpedo(ImDrawList* drawList, const PhotonTorpedo& torpedo, ImVec2 offset);
     void DrawPhaserBeam(ImDrawList* drawList, const PhaserBeam& beam, ImVec2 offset);
-    void DrawParticles(ImDrawList* drawList, const std::vector<Particle>& particles, ImVec2 offset);
-    void DrawShipDebris(ImDrawList* drawList, const std::vector<ShipDebrisSegment>& debris, ImVec2 offset);
+    void DrawParticles(ImDrawList* drawList, const AstroParticles& particles, ImVec2 offset);
+    void DrawShipDebris(ImDrawList* drawList, const AstroDebris& debris, ImVec2 offset);
+    void DrawWorld(ImDrawList* drawList, ImVec2 origin);
+    void DrawFastForward(ImVec2 origin, ImVec2 size);
     void DrawHUD();
     void DrawDebugColliders(ImDrawList* drawList, ImVec2 offset);
     ImVec2 WorldToScreen(float x, float y);
 
     std::vector<std::unique_ptr<ShipBase>> makeShips();
-
-    AstroArena _arena;
-    std::vector<std::unique_ptr<ShipBase>> _ships;
+    void SaveReplay();
+    void SeekTo(int turn);
+    AstroArena::ShipState InterpolatedShip(size_t i) const;
+
+    // The match, its effects and its replay live on the simulation thread;
+    // drawing only reads the frame acquired at the start of drawFrame()
+    AstroSimThread _sim;
+    const AstroRenderFrame* _frame = nullptr;
+    int _lastTurn = 0;
+    AstroClock _clock;
+    bool _interpolate = true;
+    float _renderAlpha = 1.0f;
+    float _renderScale = 1.0f;
+    int _seekTurn = 0;
+    int _fastForwardTurns = 1000;
     std::vector<std::string> _logLines;
     bool _logAutoScroll = true;
     bool _showColliders = false;
-    int _currentTurn;
-    bool _gameRunning;
 
     // Camera/viewport
     float _cameraX = ASTROBOTS_W / 2.0f;
@@ -0,0 +1,37 @@
+#include "AstroClock.h"
+#include <algorithm>
+#include <chrono>
+
+int AstroClock::Advance(double elapsedSeconds, const std::function<bool()>& tick) {
+    lastTicks = 0;
+    if (turbo) {
+        accumulator = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        double budget = std::max(frameBudgetMs, 0.0);
+        // always at least one turn, so turbo never runs slower than one per frame
+        do {
+            if (!tick()) break;
+            ++lastTicks;
+        } while (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() < budget);
+        return lastTicks;
+    }
+
+    const double interval = 1.0 / std::max(tickRate, 0.001);
+    accumulator += std::max(elapsedSeconds, 0.0);
+    while (accumulator >= interval) {
+        if (lastTicks >= maxCatchUp) {
+            // keep the fraction of a turn so the phase stays smooth
+            long long behind = (long long)(accumulator / interval);
+            droppedTicks += behind;
+            accumulator -= (double)behind * interval;
+            break;
+        }
+        if (!tick()) {
+            accumulator = 0.0; // nothing to step; don't bank time for later
+            break;
+        }
+        accumulator -= interval;
+        ++lastTicks;
+    }
+    return lastTicks;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <functional>
+
+// ===== AstroClock: fixed-step scheduling for the viewer =====
+// The match advances in whole turns at tickRate, independent of the render
+// frame rate. Each frame's elapsed time is banked in an accumulator and paid
+// out one turn at a time. After a long frame at most maxCatchUp turns run and
+// the rest of the backlog is dropped, so a slow frame slows the match down
+// instead of snowballing into ever longer frames. Turbo ignores the rate and
+// runs turns until frameBudgetMs of the frame is used up.
+struct AstroClock {
+    double tickRate = 30.0;      // turns per second
+    int maxCatchUp = 4;          // most turns run in one frame (rate mode)
+    bool turbo = false;
+    double frameBudgetMs = 12.0; // time per frame turbo may spend stepping
+
+    double accumulator = 0.0;    // banked seconds not yet paid out as turns
+    int lastTicks = 0;           // turns run by the last Advance()
+    long long droppedTicks = 0;  // turns skipped by the catch-up limit
+
+    // bank `elapsedSeconds` and run the turns that are due; `tick` steps one
+    // turn and returns false once there is nothing left to step
+    int Advance(double elapsedSeconds, const std::function<bool()>& tick);
+};
@@ -0,0 +1,467 @@
+#include "AstroEffects.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if !defined(ASTRO_FX_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#define ASTRO_FX_AVX2 1
+#elif !defined(ASTRO_FX_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ASTRO_FX_SSE2 1
+#endif
+
+// ===== Vector helpers =====
+// Only the handful of operations the integrators need. Selects are used
+// instead of adding a masked 0/W so a -0.0f coordinate stays bit-identical
+// to the scalar path.
+namespace {
+#if defined(ASTRO_FX_AVX2)
+constexpr size_t LANES = 8;
+using VF = __m256;
+using VI = __m256i;
+inline VF LoadF(const float* p) { return _mm256_loadu_ps(p); }
+inline void StoreF(float* p, VF v) { _mm256_storeu_ps(p, v); }
+inline VI LoadI(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline void StoreI(int* p, VI v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline VF Set(float f) { return _mm256_set1_ps(f); }
+inline VF Add(VF a, VF b) { return _mm256_add_ps(a, b); }
+inline VF Sub(VF a, VF b) { return _mm256_sub_ps(a, b); }
+inline VF Mul(VF a, VF b) { return _mm256_mul_ps(a, b); }
+inline VF Less(VF a, VF b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline VF GreaterEq(VF a, VF b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline VF Select(VF mask, VF a, VF b) { return _mm256_blendv_ps(b, a, mask); } // mask ? a : b
+inline VF AsMask(VI m) { return _mm256_castsi256_ps(m); }
+inline VI Decrement(VI v) { return _mm256_sub_epi32(v, _mm256_set1_epi32(1)); }
+#elif defined(ASTRO_FX_SSE2)
+constexpr size_t LANES = 4;
+using VF = __m128;
+using VI = __m128i;
+inline VF LoadF(const float* p) { return _mm_loadu_ps(p); }
+inline void StoreF(float* p, VF v) { _mm_storeu_ps(p, v); }
+inline VI LoadI(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+inline void StoreI(int* p, VI v) { _mm_storeu_si128((__m128i*)p, v); }
+inline VF Set(float f) { return _mm_set1_ps(f); }
+inline VF Add(VF a, VF b) { return _mm_add_ps(a, b); }
+inline VF Sub(VF a, VF b) { return _mm_sub_ps(a, b); }
+inline VF Mul(VF a, VF b) { return _mm_mul_ps(a, b); }
+inline VF Less(VF a, VF b) { return _mm_cmplt_ps(a, b); }
+inline VF GreaterEq(VF a, VF b) { return _mm_cmpge_ps(a, b); }
+inline VF Select(VF mask, VF a, VF b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline VF AsMask(VI m) { return _mm_castsi128_ps(m); }
+inline VI Decrement(VI v) { return _mm_sub_epi32(v, _mm_set1_epi32(1)); }
+#else
+constexpr size_t LANES = 0;
+#endif
+
+#if defined(ASTRO_FX_AVX2) || defined(ASTRO_FX_SSE2)
+// same result as AstroArena::WrapPosition for a single turn's displacement
+inline VF Wrap(VF v, VF size, VF zero) {
+    VF low = Less(v, zero);
+    VF high = GreaterEq(v, size);
+    v = Select(low, Add(v, size), Select(high, Sub(v, size), v));
+    return Select(GreaterEq(v, size), zero, v);
+}
+#endif
+
+inline float Wrap(float v, float size) {
+    if (v < 0) v += size;
+    else if (v >= size) v -= size;
+    if (v >= size) v = 0;
+    return v;
+}
+
+inline void StepParticle(float& x, float& y, float& vx, float& vy, int& life, bool wrap) {
+    x += vx;
+    y += vy;
+    if (wrap) {
+        x = Wrap(x, ASTROBOTS_W);
+        y = Wrap(y, ASTROBOTS_H);
+    }
+    vx *= PARTICLE_DRAG;
+    vy *= PARTICLE_DRAG;
+    life--;
+}
+
+// drift, then spin about the midpoint
+inline void StepDebris(float& x1, float& y1, float& x2, float& y2, float& vx, float& vy,
+                       float c, float s, bool spins, int& life) {
+    x1 += vx; y1 += vy;
+    x2 += vx; y2 += vy;
+    if (spins) {
+        float mx = (x1 + x2) * 0.5f;
+        float my = (y1 + y2) * 0.5f;
+        float rx = x1 - mx, ry = y1 - my;
+        float nx = rx * c - ry * s;
+        float ny = rx * s + ry * c;
+        x1 = mx + nx; y1 = my + ny;
+        rx = x2 - mx; ry = y2 - my;
+        nx = rx * c - ry * s;
+        ny = rx * s + ry * c;
+        x2 = mx + nx; y2 = my + ny;
+    }
+    vx *= SHIP_DEBRIS_DRAG;
+    vy *= SHIP_DEBRIS_DRAG;
+    life--;
+}
+} // namespace
+
+// ===== Particles =====
+void AstroParticles::SetCapacity(size_t capacity) {
+    if (capacity == x.size()) return;
+    size_t keep = count < capacity ? count : capacity;
+    size_t from = count - keep;
+    if (from > 0) {
+        for (size_t i = 0; i < keep; ++i) {
+            x[i] = x[from + i]; y[i] = y[from + i];
+            vx[i] = vx[from + i]; vy[i] = vy[from + i];
+            lifetime[i] = lifetime[from + i]; startLifetime[i] = startLifetime[from + i];
+            length[i] = length[from + i]; color[i] = color[from + i];
+        }
+    }
+    x.resize(capacity); y.resize(capacity);
+    vx.resize(capacity); vy.resize(capacity);
+    lifetime.resize(capacity); startLifetime.resize(capacity);
+    length.resize(capacity); color.resize(capacity);
+    count = keep;
+}
+
+bool AstroParticles::Push(const Particle& p) {
+    if (count == x.size()) {
+        ++dropped;
+        return false;
+    }
+    size_t i = count++;
+    x[i] = p.x; y[i] = p.y;
+    vx[i] = p.vx; vy[i] = p.vy;
+    lifetime[i] = p.lifetime;
+    startLifetime[i] = p.startLifetime;
+    length[i] = p.length;
+    color[i] = p.color;
+    return true;
+}
+
+Particle AstroParticles::Get(size_t i) const {
+    Particle p;
+    p.x = x[i]; p.y = y[i];
+    p.vx = vx[i]; p.vy = vy[i];
+    p.length = length[i];
+    p.lifetime = lifetime[i];
+    p.startLifetime = startLifetime[i];
+    p.color = color[i];
+    p.alive = lifetime[i] > 0;
+    return p;
+}
+
+void AstroParticles::Update(bool wrap) {
+    size_t i = 0;
+#if defined(ASTRO_FX_AVX2) || defined(ASTRO_FX_SSE2)
+    const VF zero = Set(0.0f), w = Set(ASTROBOTS_W), h = Set(ASTROBOTS_H), drag = Set(PARTICLE_DRAG);
+    float* px = x.data(); float* py = y.data();
+    float* pvx = vx.data(); float* pvy = vy.data();
+    int* life = lifetime.data();
+    for (; i + LANES <= count; i += LANES) {
+        VF vxs = LoadF(pvx + i), vys = LoadF(pvy + i);
+        VF xs = Add(LoadF(px + i), vxs);
+        VF ys = Add(LoadF(py + i), vys);
+        if (wrap) {
+            xs = Wrap(xs, w, zero);
+            ys = Wrap(ys, h, zero);
+        }
+        StoreF(px + i, xs);
+        StoreF(py + i, ys);
+        StoreF(pvx + i, Mul(vxs, drag));
+        StoreF(pvy + i, Mul(vys, drag));
+        StoreI(life + i, Decrement(LoadI(life + i)));
+    }
+#endif
+    for (; i < count; ++i) StepParticle(x[i], y[i], vx[i], vy[i], lifetime[i], wrap);
+    Compact();
+}
+
+void AstroParticles::UpdateScalar(bool wrap) {
+    for (size_t i = 0; i < count; ++i) StepParticle(x[i], y[i], vx[i], vy[i], lifetime[i], wrap);
+    Compact();
+}
+
+void AstroParticles::Compact() {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (lifetime[i] <= 0) continue;
+        if (kept != i) {
+            x[kept] = x[i]; y[kept] = y[i];
+            vx[kept] = vx[i]; vy[kept] = vy[i];
+            lifetime[kept] = lifetime[i]; startLifetime[kept] = startLifetime[i];
+            length[kept] = length[i]; color[kept] = color[i];
+        }
+        ++kept;
+    }
+    count = kept;
+}
+
+// ===== Ship debris =====
+void AstroDebris::Reserve(size_t capacity) {
+    if (capacity <= x1.size()) return;
+    x1.resize(capacity); y1.resize(capacity); x2.resize(capacity); y2.resize(capacity);
+    vx.resize(capacity); vy.resize(capacity);
+    spinCos.resize(capacity); spinSin.resize(capacity); spinMask.resize(capacity);
+    lifetime.resize(capacity); angVel.resize(capacity);
+    startLifetime.resize(capacity); color.resize(capacity);
+}
+
+void AstroDebris::Push(const ShipDebrisSegment& d) {
+    if (count == x1.size()) Reserve(count ? count * 2 : 64);
+    size_t i = count++;
+    x1[i] = d.x1; y1[i] = d.y1; x2[i] = d.x2; y2[i] = d.y2;
+    vx[i] = d.vx; vy[i] = d.vy;
+    angVel[i] = d.angVel;
+    spinCos[i] = std::cos(d.angVel);
+    spinSin[i] = std::sin(d.angVel);
+    spinMask[i] = std::abs(d.angVel) > 1e-6f ? -1 : 0;
+    lifetime[i] = d.lifetime;
+    startLifetime[i] = d.startLifetime;
+    color[i] = d.color;
+}
+
+ShipDebrisSegment AstroDebris::Get(size_t i) const {
+    ShipDebrisSegment d;
+    d.x1 = x1[i]; d.y1 = y1[i]; d.x2 = x2[i]; d.y2 = y2[i];
+    d.vx = vx[i]; d.vy = vy[i];
+    d.angVel = angVel[i];
+    d.lifetime = lifetime[i];
+    d.startLifetime = startLifetime[i];
+    d.color = color[i];
+    d.alive = lifetime[i] > 0;
+    return d;
+}
+
+void AstroDebris::Update() {
+    size_t i = 0;
+#if defined(ASTRO_FX_AVX2) || defined(ASTRO_FX_SSE2)
+    const VF half = Set(0.5f), drag = Set(SHIP_DEBRIS_DRAG);
+    int* life = lifetime.data();
+    for (; i + LANES <= count; i += LANES) {
+        VF vxs = LoadF(vx.data() + i), vys = LoadF(vy.data() + i);
+        VF ax = Add(LoadF(x1.data() + i), vxs), ay = Add(LoadF(y1.data() + i), vys);
+        VF bx = Add(LoadF(x2.data() + i), vxs), by = Add(LoadF(y2.data() + i), vys);
+        VF c = LoadF(spinCos.data() + i), s = LoadF(spinSin.data() + i);
+        VF spins = AsMask(LoadI(spinMask.data() + i));
+        VF mx = Mul(Add(ax, bx), half);
+        VF my = Mul(Add(ay, by), half);
+        VF rx = Sub(ax, mx), ry = Sub(ay, my);
+        VF rax = Add(mx, Sub(Mul(rx, c), Mul(ry, s)));
+        VF ray = Add(my, Add(Mul(rx, s), Mul(ry, c)));
+        rx = Sub(bx, mx); ry = Sub(by, my);
+        VF rbx = Add(mx, Sub(Mul(rx, c), Mul(ry, s)));
+        VF rby = Add(my, Add(Mul(rx, s), Mul(ry, c)));
+        StoreF(x1.data() + i, Select(spins, rax, ax));
+        StoreF(y1.data() + i, Select(spins, ray, ay));
+        StoreF(x2.data() + i, Select(spins, rbx, bx));
+        StoreF(y2.data() + i, Select(spins, rby, by));
+        StoreF(vx.data() + i, Mul(vxs, drag));
+        StoreF(vy.data() + i, Mul(vys, drag));
+        StoreI(life + i, Decrement(LoadI(life + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        StepDebris(x1[i], y1[i], x2[i], y2[i], vx[i], vy[i], spinCos[i], spinSin[i], spinMask[i] != 0, lifetime[i]);
+    }
+    Compact();
+}
+
+void AstroDebris::UpdateScalar() {
+    for (size_t i = 0; i < count; ++i) {
+        StepDebris(x1[i], y1[i], x2[i], y2[i], vx[i], vy[i], spinCos[i], spinSin[i], spinMask[i] != 0, lifetime[i]);
+    }
+    Compact();
+}
+
+void AstroDebris::Compact() {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (lifetime[i] <= 0) continue;
+        if (kept != i) {
+            x1[kept] = x1[i]; y1[kept] = y1[i]; x2[kept] = x2[i]; y2[kept] = y2[i];
+            vx[kept] = vx[i]; vy[kept] = vy[i];
+            spinCos[kept] = spinCos[i]; spinSin[kept] = spinSin[i]; spinMask[kept] = spinMask[i];
+            lifetime[kept] = lifetime[i]; angVel[kept] = angVel[i];
+            startLifetime[kept] = startLifetime[i]; color[kept] = color[i];
+        }
+        ++kept;
+    }
+    count = kept;
+}
+
+// ===== Effects from sim events =====
+void AstroEffects::Reset(uint64_t matchSeed, size_t shipCount) {
+    Clear();
+    rngParticles.Seed(matchSeed, ASTRO_RNG_PARTICLES);
+    rngDebris.Seed(matchSeed, ASTRO_RNG_DEBRIS);
+    phaserBeams.reserve(std::max(ASTRO_POOL_PHASER_BEAMS, shipCount));
+    particles.SetCapacity(particleCapacity ? particleCapacity : std::max(ASTRO_POOL_PARTICLES, shipCount * 64));
+    shipDebris.Reserve(std::max(ASTRO_POOL_DEBRIS, shipCount * 16));
+}
+
+void AstroEffects::Clear() {
+    phaserBeams.clear();
+    particles.Clear();
+    shipDebris.Clear();
+}
+
+void AstroEffects::Update() {
+    for (auto& beam : phaserBeams) {
+        beam.lifetime--;
+        if (beam.lifetime <= 0) beam.alive = false;
+    }
+    phaserBeams.erase(
+        std::remove_if(phaserBeams.begin(), phaserBeams.end(),
+                       [](const PhaserBeam& b) { return !b.alive; }),
+        phaserBeams.end()
+    );
+    particles.Update(PARTICLE_WRAP != 0);
+    // ship debris does not wrap; it drifts off-screen
+    shipDebris.Update();
+}
+
+void AstroEffects::Apply(const AstroArena& arena) {
+    for (const AstroEvent& e : arena.events) {
+        switch (e.type) {
+            case ASTRO_EVENT_PHASER_FIRE: {
+                PhaserBeam beam;
+                beam.x1 = e.x; beam.y1 = e.y;
+                beam.x2 = e.x2; beam.y2 = e.y2;
+                beam.lifetime = 3;
+                beam.color = ASTRO_COL32(255, 100, 100, 255);
+                beam.alive = true;
+                phaserBeams.push_back(beam);
+                break;
+            }
+            case ASTRO_EVENT_PHASER_HIT_SHIP:
+                SpawnParticleBurst(e.x, e.y, 28, ASTRO_COL32(255, 160, 120, 255), 0.8f, 0.7f);
+                break;
+            case ASTRO_EVENT_PHASER_HIT_ASTEROID:
+                SpawnParticleBurst(e.x, e.y, 36, ASTRO_COL32(255, 120, 120, 255), 0.9f, 0.8f);
+                break;
+            case ASTRO_EVENT_TORPEDO_HIT_SHIP:
+                SpawnParticleBurst(e.x, e.y, 42, ASTRO_COL32(255, 200, 140, 255), 1.0f, 1.0f);
+                SpawnParticleBurst(e.x, e.y, 20, ASTRO_COL32(255, 255, 200, 255), 1.7f, 0.5f);
+                break;
+            case ASTRO_EVENT_TORPEDO_HIT_ASTEROID:
+                SpawnParticleBurst(e.x, e.y, 48, ASTRO_COL32(255, 180, 140, 255), 1.0f, 1.0f);
+                SpawnParticleBurst(e.x, e.y, 25, ASTRO_COL32(255, 255, 200, 255), 1.8f, 0.6f);
+                break;
+            case ASTRO_EVENT_RAM_ASTEROID:
+                SpawnParticleBurst(e.x, e.y, 24, ASTRO_COL32(255, 150, 120, 255));
+                break;
+            case ASTRO_EVENT_SHIP_KILLED: {
+                if (e.ship < 0 || e.ship >= (int)arena.ships.size()) break;
+                const auto& s = arena.ships[e.ship];
+                SpawnParticleBurst(e.x, e.y, 150, s.color, 1.2f, 1.5f);
+                SpawnParticleBurst(e.x, e.y, 80, ASTRO_COL32(255, 255, 220, 255), 2.2f, 0.8f);
+                SpawnShipDebris(s, arena.renderScale);
+                break;
+            }
+            default:
+                break; // photon launches and asteroid breaks have no effect of their own
+        }
+    }
+}
+
+void AstroEffects::SpawnParticleBurst(float x, float y, int count, AstroColor baseColor, float speedScale, float lifeScale, float particleLength) {
+    AstroRng& rng = rngParticles;
+    // a full pool drops the rest of the burst without drawing its random numbers
+    size_t room = particles.Capacity() - particles.Size();
+    if ((size_t)count > room) {
+        particles.dropped += (size_t)count - room;
+        count = (int)room;
+    }
+    for (int i = 0; i < count; ++i) {
+        float a = rng.Uniform(0.0f, 2.0f * (float)M_PI);
+        float s = rng.Uniform(PARTICLE_MIN_SPEED, PARTICLE_MAX_SPEED) * speedScale;
+        Particle p;
+        p.x = x; p.y = y;
+        p.vx = std::cos(a) * s;
+        p.vy = std::sin(a) * s;
+        p.lifetime = std::max(10, (int)(rng.Range(PARTICLE_DEFAULT_LIFETIME - 15, PARTICLE_DEFAULT_LIFETIME + 15) * lifeScale));
+        p.startLifetime = p.lifetime;
+        p.length = particleLength * rng.Uniform(0.7f, 1.3f);
+        int r = (int)((baseColor >> ASTRO_COL32_R_SHIFT) & 0xFF);
+        int g = (int)((baseColor >> ASTRO_COL32_G_SHIFT) & 0xFF);
+        int b = (int)((baseColor >> ASTRO_COL32_B_SHIFT) & 0xFF);
+        r = std::min(255, std::max(0, r + rng.Range(-40, 40)));
+        g = std::min(255, std::max(0, g + rng.Range(-40, 40)));
+        b = std::min(255, std::max(0, b + rng.Range(-40, 40)));
+        p.color = ASTRO_COL32(r, g, b, 255);
+        p.alive = true;
+        particles.Push(p);
+    }
+}
+
+// Asteroids-style breakup debris from the ship's triangle outline
+void AstroEffects::SpawnShipDebris(const AstroArena::ShipState& s, float renderScale) {
+    // Reconstruct ship triangle in world space
+    float angleRad = s.angle * (float)M_PI / 180.0f;
+    // Convert screen-size triangle length to world units using current renderScale
+    float size = SHIP_DRAW_SIZE;
+    if (renderScale > 0.00001f) {
+        size = SHIP_DRAW_SIZE / renderScale;
+    }
+    c2v nose = c2V(s.x + std::cos(angleRad) * size,
+                   s.y + std::sin(angleRad) * size);
+    c2v leftWing = c2V(s.x + std::cos(angleRad + 2.4f) * size * 0.6f,
+                       s.y + std::sin(angleRad + 2.4f) * size * 0.6f);
+    c2v rightWing = c2V(s.x + std::cos(angleRad - 2.4f) * size * 0.6f,
+                        s.y + std::sin(angleRad - 2.4f) * size * 0.6f);
+
+    // Triangle centroid
+    c2v center = c2V((nose.x + leftWing.x + rightWing.x) / 3.0f,
+                     (nose.y + leftWing.y + rightWing.y) / 3.0f);
+
+    std::array<std::pair<c2v, c2v>, 3> edges = {{
+        { nose, leftWing },
+        { leftWing, rightWing },
+        { rightWing, nose }
+    }};
+
+    for (const auto& e : edges) {
+        c2v a = e.first;
+        c2v b = e.second;
+        for (int i = 0; i < SHIP_DEBRIS_COUNT_PER_EDGE; ++i) {
+            float t0 = (float)i / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
+            float t1 = (float)(i + 1) / (float)SHIP_DEBRIS_COUNT_PER_EDGE;
+            t0 = std::max(0.0f, std::min(1.0f, t0 + rngDebris.Uniform(-0.07f, 0.07f)));
+            t1 = std::max(0.0f, std::min(1.0f, t1 + rngDebris.Uniform(-0.07f, 0.07f)));
+            if (t1 < t0) std::swap(t0, t1);
+            c2v p0 = c2V(a.x + (b.x - a.x) * t0, a.y + (b.y - a.y) * t0);
+            c2v p1 = c2V(a.x + (b.x - a.x) * t1, a.y + (b.y - a.y) * t1);
+
+            // Midpoint and outward direction from centroid
+            c2v mid = c2V((p0.x + p1.x) * 0.5f, (p0.y + p1.y) * 0.5f);
+            float dx = mid.x - center.x;
+            float dy = mid.y - center.y;
+            float len = std::sqrt(dx*dx + dy*dy);
+            if (len < 1e-5f) { dx = 1.0f; dy = 0.0f; len = 1.0f; }
+            dx /= len; dy /= len;
+
+            float spd = rngDebris.Uniform(0.6f, 1.8f);
+
+            ShipDebrisSegment seg;
+            seg.x1 = p0.x; seg.y1 = p0.y;
+            seg.x2 = p1.x; seg.y2 = p1.y;
+            // Inherit some ship velocity, add outward impulse and slight downward bias
+            seg.vx = s.vx + dx * spd;
+            seg.vy = s.vy + dy * spd + 0.15f;
+            seg.angVel = rngDebris.Uniform(-0.05f, 0.05f);
+            seg.startLifetime = SHIP_DEBRIS_LIFETIME + rngDebris.Range(-10, 10);
+            if (seg.startLifetime < 20) seg.startLifetime = 20;
+            seg.lifetime = seg.startLifetime;
+            seg.color = s.color;
+            seg.alive = true;
+            shipDebris.Push(seg);
+        }
+    }
+}
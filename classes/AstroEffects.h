@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+
+// ===== Cosmetic effect pools (particles and ship debris) =====
+// Structure-of-arrays storage: Update() streams through the hot kinematic
+// columns (position, velocity, lifetime) with SIMD, while the colour, length
+// and start-lifetime columns are only read when drawing. Live entries are kept
+// packed at the front in spawn order, so update and draw cost follow the live
+// count. Particle and ShipDebrisSegment remain the one-entry view used to
+// spawn and draw.
+//
+// The SIMD paths (AVX2 when the compiler targets it, otherwise SSE2 on x86)
+// perform exactly the scalar operations in the same order, so UpdateScalar()
+// produces bit-identical results; astro_sim --fx-bench checks this. That
+// needs the compiler not to fuse the scalar multiply-adds into FMAs, so this
+// file is built with -ffp-contract=off (see CMakeLists.txt).
+
+#if defined(ASTRO_FX_SCALAR)
+#define ASTRO_FX_SIMD_NAME "scalar"
+#elif defined(__AVX2__)
+#define ASTRO_FX_SIMD_NAME "AVX2"
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ASTRO_FX_SIMD_NAME "SSE2"
+#else
+#define ASTRO_FX_SIMD_NAME "scalar"
+#endif
+
+template <class Pool, class Entry>
+struct AstroFxIter {
+    const Pool* pool;
+    size_t i;
+    Entry operator*() const { return pool->Get(i); }
+    AstroFxIter& operator++() { ++i; return *this; }
+    bool operator!=(const AstroFxIter& o) const { return i != o.i; }
+};
+
+// Fixed capacity: spawns that do not fit are refused and counted in `dropped`.
+struct AstroParticles {
+    // hot
+    std::vector<float> x, y, vx, vy;
+    std::vector<int> lifetime;
+    // cold
+    std::vector<int> startLifetime;
+    std::vector<float> length;
+    std::vector<AstroColor> color;
+    size_t count = 0;
+    uint64_t dropped = 0; // spawns refused because the pool was full (since Clear)
+
+    size_t Capacity() const { return x.size(); }
+    size_t Size() const { return count; }
+    void Clear() { count = 0; dropped = 0; }
+    void SetCapacity(size_t capacity); // keeps the newest particles that fit
+    bool Push(const Particle& p);      // false (and counted) when full
+    Particle Get(size_t i) const;
+
+    // advance one turn (move, wrap, drag, age) and drop the expired particles
+    void Update(bool wrap);
+    void UpdateScalar(bool wrap); // reference implementation of Update()
+
+    AstroFxIter<AstroParticles, Particle> begin() const { return { this, 0 }; }
+    AstroFxIter<AstroParticles, Particle> end() const { return { this, count }; }
+
+private:
+    void Compact();
+};
+
+// Grows as needed (a kill only adds a handful of segments). The spin of each
+// segment is constant, so its rotation is computed once when it is pushed.
+struct AstroDebris {
+    // hot
+    std::vector<float> x1, y1, x2, y2, vx, vy;
+    std::vector<float> spinCos, spinSin;
+    std::vector<int> spinMask; // -1 (all bits set) when |angVel| is large enough to rotate, else 0
+    std::vector<int> lifetime;
+    // cold
+    std::vector<float> angVel;
+    std::vector<int> startLifetime;
+    std::vector<AstroColor> color;
+    size_t count = 0;
+
+    size_t Size() const { return count; }
+    void Clear() { count = 0; }
+    void Reserve(size_t capacity);
+    void Push(const ShipDebrisSegment& d);
+    ShipDebrisSegment Get(size_t i) const;
+
+    void Update();
+    void UpdateScalar();
+
+    AstroFxIter<AstroDebris, ShipDebrisSegment> begin() const { return { this, 0 }; }
+    AstroFxIter<AstroDebris, ShipDebrisSegment> end() const { return { this, count }; }
+
+private:
+    void Compact();
+};
+
+// ===== AstroEffects: turns sim events into visuals =====
+// Lives next to the match in a renderer, never inside it. After each Step()
+// the renderer calls Update() to age what is on screen and Apply() to spawn
+// beams, particle bursts and debris for the turn's AstroArena::events. The
+// particle and debris RNG streams are seeded from the match seed, so a match
+// always looks the same, but nothing here feeds back into the simulation and
+// headless runs never construct one.
+struct AstroEffects {
+    std::vector<PhaserBeam> phaserBeams;
+    AstroParticles particles;
+    AstroDebris shipDebris;
+    AstroRng rngParticles;
+    AstroRng rngDebris;
+    size_t particleCapacity = 0; // particle pool size; 0 sizes it from ASTRO_POOL_PARTICLES and the roster
+
+    // clear everything and size the pools for a match with `shipCount` ships
+    void Reset(uint64_t matchSeed, size_t shipCount);
+    void Clear();
+    void Update();
+    void Apply(const AstroArena& arena);
+
+    void SpawnParticleBurst(float x, float y, int count, AstroColor baseColor, float speedScale = 1.0f, float lifeScale = 1.0f, float particleLength = PARTICLE_LENGTH);
+    void SpawnShipDebris(const AstroArena::ShipState& s, float renderScale);
+};
@@ -0,0 +1,177 @@
+#include "AstroMatch.h"
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void AstroMatch::Setup(std::vector<std::unique_ptr<ShipBase>> roster, uint64_t seed) {
+    Clear();
+    arena.Seed(seed);
+    if (arena.log) arena.log("Match seed " + std::to_string(seed));
+    ships = std::move(roster);
+    arena.ships.resize(ships.size());
+    arena.ReservePools();
+
+    AstroColor shipColors[] = {
+        ASTRO_COL32(255, 80, 80, 255),   // Red
+        ASTRO_COL32(80, 255, 80, 255),   // Green
+        ASTRO_COL32(80, 180, 255, 255),  // Blue
+        ASTRO_COL32(255, 255, 80, 255),  // Yellow
+        ASTRO_COL32(255, 80, 255, 255),  // Magenta
+        ASTRO_COL32(80, 255, 255, 255),   // Cyan
+        ASTRO_COL32(255, 160, 0, 255),    // Orange
+        ASTRO_COL32(128, 0, 128, 255)     // Purple
+    };
+
+    // Validate scripts & inject arena refs
+    for (size_t i = 0; i < ships.size(); ++i) {
+        int cost = ships[i]->SetupShip();
+        // log the ship setup cost and show the name, highlight if it exceeds the limit
+        if (arena.log) {
+            std::string line = ships[i]->name + " script cost " + std::to_string(cost) + "/" + std::to_string(ASTRO_MAX_SCRIPT_COST);
+            if (cost > ASTRO_MAX_SCRIPT_COST) line += " (EXCEEDS LIMIT)";
+            arena.log(line);
+        }
+        if (!ships[i]->linked) ships[i]->Link();
+        if (!ships[i]->linkError.empty() && arena.log) {
+            arena.log(ships[i]->name + " script rejected, ship will idle: " + ships[i]->linkError);
+        }
+        arena.ships[i].ship = ships[i].get();
+        arena.ships[i].color = shipColors[i % 6];
+        ships[i]->A = &arena;
+        ships[i]->id = (int)i;
+    }
+
+    // Spawn ships in a circle around the center
+    float centerX = ASTROBOTS_W / 2.0f;
+    float centerY = ASTROBOTS_H / 2.0f;
+    float spawnRadius = 300.0f;
+
+    for (size_t i = 0; i < arena.ships.size(); ++i) {
+        float angle = (float)i / ships.size() * 2.0f * M_PI;
+        arena.ships[i].x = centerX + std::cos(angle) * spawnRadius;
+        arena.ships[i].y = centerY + std::sin(angle) * spawnRadius;
+        arena.ships[i].angle = angle * 180.0f / M_PI;
+        arena.ships[i].targetAngle = arena.ships[i].angle;
+        arena.ships[i].vx = 0;
+        arena.ships[i].vy = 0;
+    }
+
+    // Spawn asteroids
+    arena.SpawnAsteroids(NUM_INITIAL_ASTEROIDS);
+
+    turn = 0;
+    running = true;
+}
+
+bool AstroMatch::Step() {
+    if (!running) return false;
+
+    turn++;
+
+    if (turn > ASTRO_MAX_TURNS) {
+        running = false;
+        return false;
+    }
+
+    // Start turn (reset cooldowns, etc.)
+    arena.StartTurn();
+
+    // Each alive ship takes a turn
+    if (simultaneousTurns) arena.BeginIntents();
+    auto runShip = [this](int i) {
+        if (!arena.ships[i].alive) return;
+        if (compiledScripts) {
+            ships[i]->RunCompiled();
+        } else {
+            ships[i]->Run(turn);
+        }
+    };
+    if (batchedScripts) {
+        batch.Run(arena, ships);
+    } else if (simultaneousTurns && scriptThreads > 1) {
+        // scripts only write their own ship state and intent slot in this mode
+        if (!pool || pool->Size() != scriptThreads) pool = std::make_unique<AstroThreadPool>(scriptThreads);
+        pool->ParallelFor((int)ships.size(), runShip);
+    } else {
+        for (int i = 0; i < (int)ships.size(); ++i) runShip(i);
+    }
+    if (simultaneousTurns) arena.ResolveIntents();
+
+    // Update physics
+    arena.UpdatePhysics();
+
+    // Handle collisions
+    arena.HandleCollisions();
+    arena.HandleTorpedoes();
+
+    // After handling torpedo collisions based on unwrapped motion, wrap torpedoes
+    for (auto& t : arena.torpedoes) {
+        if (t.alive) {
+            arena.WrapPosition(t.x, t.y);
+        }
+    }
+
+    // Clean up dead torpedoes and asteroids
+    arena.torpedoes.erase(
+        std::remove_if(arena.torpedoes.begin(), arena.torpedoes.end(),
+                      [](const PhotonTorpedo& t) { return !t.alive; }),
+        arena.torpedoes.end()
+    );
+    arena.CompactAsteroids();
+
+    // Maintain asteroid population by spawning from edges with a cooldown
+    if (arena.edgeSpawnCooldown > 0) {
+        arena.edgeSpawnCooldown--;
+    }
+    if (arena.asteroids.size() < NUM_INITIAL_ASTEROIDS && arena.edgeSpawnCooldown == 0) {
+        arena.SpawnAsteroidFromEdge();
+        arena.edgeSpawnCooldown = 60; // spawn at most every ~2 seconds (at 30Hz)
+    }
+
+    // Check if game over
+    if (AliveCount() <= 1) {
+        running = false;
+    }
+    return running;
+}
+
+void AstroMatch::Clear() {
+    running = false;
+    turn = 0;
+
+    // Clear all arena state
+    arena.torpedoes.clear();
+    arena.asteroids.clear();
+    arena.signals.clear();
+    arena.ships.clear();
+    arena.events.clear();
+    arena.edgeSpawnCooldown = 0;
+    arena.spatialDirty = true;
+
+    // Clear ship scripts
+    ships.clear();
+    batch.Clear();
+}
+
+int AstroMatch::AliveCount() const {
+    int alive = 0;
+    for (const auto& s : arena.ships) {
+        if (s.alive) alive++;
+    }
+    return alive;
+}
+
+int AstroMatch::Winner() const {
+    if (running || AliveCount() != 1) return -1;
+    for (size_t i = 0; i < arena.ships.size(); ++i) {
+        if (arena.ships[i].alive) return (int)i;
+    }
+    return -1;
+}
+
+bool AstroMatch::IsDraw() const {
+    return !running && turn >= ASTRO_MAX_TURNS && AliveCount() > 1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+#include "AstroShip.h"
+#include "AstroBatchVM.h"
+#include "AstroThreadPool.h"
+
+// ===== AstroMatch: headless match driver =====
+// Owns one arena plus the ship programs racing in it and knows how to advance
+// the simulation a turn at a time. Nothing in here touches ImGui, so the same
+// stepping code drives the viewer (AstroBots) and the command line runner.
+struct AstroMatch {
+    AstroArena arena;
+    std::vector<std::unique_ptr<ShipBase>> ships;
+    int turn = 0;
+    bool running = false;
+    bool compiledScripts = false; // run ships with ShipBase::RunCompiled() instead of the interpreter
+    bool batchedScripts = false;  // run all scripts in lockstep through `batch` (deferred weapon fire)
+    AstroBatchVM batch;
+    // Two-phase turns: scripts only record weapon/signal intents, which the arena
+    // resolves together once every script has run (see AstroArena::ResolveIntents),
+    // so script order no longer decides who shoots first. Only in this mode can
+    // the scripts of one turn run on several threads.
+    bool simultaneousTurns = false;
+    int scriptThreads = 1;                // > 1 needs simultaneousTurns
+    std::unique_ptr<AstroThreadPool> pool; // created on first use
+
+    // compile ship scripts, place ships in a ring and seed the asteroid field;
+    // the same roster and seed always replay the same match
+    void Setup(std::vector<std::unique_ptr<ShipBase>> roster, uint64_t seed);
+    // advance one turn; returns false once the match has ended
+    bool Step();
+    void Clear();
+
+    int AliveCount() const;
+    int Winner() const;   // index of the last ship standing, -1 if none
+    bool IsDraw() const;  // turn limit reached with more than one survivor
+
+    // read-only access for renderers
+    const AstroArena& View() const { return arena; }
+};
@@ -0,0 +1,280 @@
+#include "AstroReplay.h"
+#include "AstroMatch.h"
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+
+// ===== Encoding helpers =====
+static void PutVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+static void PutSigned(std::vector<uint8_t>& out, int64_t v) {
+    PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); // zigzag
+}
+
+static bool GetVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= in.size()) return false;
+        uint8_t b = in[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool GetSigned(const std::vector<uint8_t>& in, size_t& pos, int64_t& v) {
+    uint64_t u;
+    if (!GetVarint(in, pos, u)) return false;
+    v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return true;
+}
+
+// field order used by the change mask
+static int32_t* ReplayField(AstroReplayShip& s, int i) {
+    int32_t* fields[] = { &s.x, &s.y, &s.angle, &s.hp, &s.fuel, &s.alive, &s.effects };
+    return fields[i];
+}
+static constexpr int REPLAY_FIELD_COUNT = 7;
+
+void QuantizeReplayShips(const AstroMatch& match, std::vector<AstroReplayShip>& out) {
+    out.resize(match.arena.ships.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        const auto& s = match.arena.ships[i];
+        AstroReplayShip& q = out[i];
+        q.x = (int32_t)std::lround(s.x * 8.0f);
+        q.y = (int32_t)std::lround(s.y * 8.0f);
+        q.angle = (int32_t)std::lround(s.angle * 16.0f);
+        q.hp = s.hp;
+        q.fuel = (int32_t)std::lround(s.fuel * 10.0f);
+        q.alive = s.alive ? 1 : 0;
+        q.effects = s.effects;
+    }
+}
+
+// ===== Writer =====
+void AstroReplayWriter::Begin(const AstroMatch& match, const std::vector<std::string>& names, std::ostream* sink) {
+    _bytes.clear();
+    _prev.clear();
+    _sink = sink;
+    _flushed = 0;
+    _lastTurn = -1;
+
+    const char magic[4] = { 'A', 'S', 'R', 'P' };
+    _bytes.insert(_bytes.end(), magic, magic + 4);
+    _bytes.push_back((uint8_t)ASTRO_REPLAY_VERSION);
+    for (int i = 0; i < 8; ++i) _bytes.push_back((uint8_t)(match.arena.matchSeed >> (8 * i)));
+    uint8_t mode = 0;
+    if (match.compiledScripts) mode |= ASTRO_REPLAY_COMPILED;
+    if (match.batchedScripts) mode |= ASTRO_REPLAY_BATCHED;
+    if (match.simultaneousTurns) mode |= ASTRO_REPLAY_SIMULTANEOUS;
+    _bytes.push_back(mode);
+    PutVarint(_bytes, names.size());
+    for (const auto& n : names) {
+        PutVarint(_bytes, n.size());
+        _bytes.insert(_bytes.end(), n.begin(), n.end());
+    }
+    RecordTurn(match);
+}
+
+void AstroReplayWriter::RecordTurn(const AstroMatch& match) {
+    // Step() bumps the turn past the limit without simulating; seeking back in
+    // the viewer replays turns we already have
+    if (match.turn <= _lastTurn || match.turn > ASTRO_MAX_TURNS) return;
+
+    QuantizeReplayShips(match, _cur);
+    bool keyframe = (match.turn != _lastTurn + 1) || (match.turn % ASTRO_REPLAY_KEYFRAME_INTERVAL == 0) ||
+                    _prev.size() != _cur.size();
+    if (keyframe) {
+        _bytes.push_back('K');
+        PutVarint(_bytes, (uint64_t)match.turn);
+        for (auto& q : _cur) {
+            for (int f = 0; f < REPLAY_FIELD_COUNT; ++f) PutSigned(_bytes, *ReplayField(q, f));
+        }
+    } else {
+        _bytes.push_back('D');
+        for (size_t i = 0; i < _cur.size(); ++i) {
+            uint8_t mask = 0;
+            for (int f = 0; f < REPLAY_FIELD_COUNT; ++f) {
+                if (*ReplayField(_cur[i], f) != *ReplayField(_prev[i], f)) mask |= (uint8_t)(1 << f);
+            }
+            _bytes.push_back(mask);
+            for (int f = 0; f < REPLAY_FIELD_COUNT; ++f) {
+                if (mask & (1 << f)) PutSigned(_bytes, (int64_t)*ReplayField(_cur[i], f) - *ReplayField(_prev[i], f));
+            }
+        }
+    }
+    _prev.swap(_cur);
+    _lastTurn = match.turn;
+    if (keyframe) Flush();
+}
+
+void AstroReplayWriter::Flush() {
+    if (!_sink || _flushed >= _bytes.size()) return;
+    _sink->write((const char*)_bytes.data() + _flushed, (std::streamsize)(_bytes.size() - _flushed));
+    _sink->flush();
+    _flushed = _bytes.size();
+}
+
+// ===== Reader =====
+// Decode one record at pos into ships (which must hold the previous turn for deltas)
+static bool DecodeRecord(const std::vector<uint8_t>& in, size_t& pos, std::vector<AstroReplayShip>& ships, int& turn) {
+    if (pos >= in.size()) return false;
+    uint8_t tag = in[pos++];
+    if (tag == 'K') {
+        uint64_t t;
+        if (!GetVarint(in, pos, t)) return false;
+        turn = (int)t;
+        for (auto& q : ships) {
+            for (int f = 0; f < REPLAY_FIELD_COUNT; ++f) {
+                int64_t v;
+                if (!GetSigned(in, pos, v)) return false;
+                *ReplayField(q, f) = (int32_t)v;
+            }
+        }
+        return true;
+    }
+    if (tag == 'D') {
+        turn++;
+        for (auto& q : ships) {
+            if (pos >= in.size()) return false;
+            uint8_t mask = in[pos++];
+            for (int f = 0; f < REPLAY_FIELD_COUNT; ++f) {
+                if (!(mask & (1 << f))) continue;
+                int64_t d;
+                if (!GetSigned(in, pos, d)) return false;
+                *ReplayField(q, f) += (int32_t)d;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool AstroReplayReader::Load(std::vector<uint8_t> bytes, std::string& error) {
+    _bytes = std::move(bytes);
+    _keyframes.clear();
+    _lastTurn = -1;
+    names.clear();
+
+    size_t pos = 0;
+    if (_bytes.size() < 14 || _bytes[0] != 'A' || _bytes[1] != 'S' || _bytes[2] != 'R' || _bytes[3] != 'P') {
+        error = "not an AstroBots replay";
+        return false;
+    }
+    if (_bytes[4] != ASTRO_REPLAY_VERSION) {
+        error = "unsupported replay version " + std::to_string(_bytes[4]);
+        return false;
+    }
+    seed = 0;
+    for (int i = 0; i < 8; ++i) seed |= (uint64_t)_bytes[5 + i] << (8 * i);
+    mode = _bytes[13];
+    pos = 14;
+    uint64_t count;
+    if (!GetVarint(_bytes, pos, count) || count > 4096) {
+        error = "corrupt replay header";
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t len;
+        if (!GetVarint(_bytes, pos, len) || pos + len > _bytes.size()) {
+            error = "corrupt replay header";
+            return false;
+        }
+        names.emplace_back((const char*)_bytes.data() + pos, (size_t)len);
+        pos += (size_t)len;
+    }
+
+    // Walk every record once to index keyframes; a truncated tail (e.g. a
+    // recording that is still being streamed) just ends the replay early
+    std::vector<AstroReplayShip> ships(names.size());
+    int turn = -1;
+    while (pos < _bytes.size()) {
+        size_t start = pos;
+        bool isKey = _bytes[pos] == 'K';
+        if (!isKey && _keyframes.empty()) break;
+        if (!DecodeRecord(_bytes, pos, ships, turn)) break;
+        if (isKey) _keyframes.push_back({ turn, start });
+        _lastTurn = turn;
+    }
+    if (_keyframes.empty()) {
+        error = "replay has no turns";
+        return false;
+    }
+    return true;
+}
+
+bool AstroReplayReader::LoadFile(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return Load(std::move(bytes), error);
+}
+
+bool AstroReplayReader::ShipsAt(int turn, std::vector<AstroReplayShip>& out) const {
+    if (turn < 0 || turn > _lastTurn || _keyframes.empty() || turn < _keyframes.front().turn) return false;
+    size_t k = 0;
+    while (k + 1 < _keyframes.size() && _keyframes[k + 1].turn <= turn) ++k;
+
+    out.assign(names.size(), AstroReplayShip());
+    size_t pos = _keyframes[k].offset;
+    int t = -1;
+    while (t < turn) {
+        if (!DecodeRecord(_bytes, pos, out, t)) return false;
+    }
+    return t == turn;
+}
+
+bool AstroReplaySeek(const AstroReplayReader& replay, int turn, AstroMatch& match, std::string& error) {
+    if (turn < 0 || turn > replay.LastTurn()) {
+        error = "turn " + std::to_string(turn) + " is not in the replay";
+        return false;
+    }
+    std::vector<std::unique_ptr<ShipBase>> ships;
+    for (const auto& n : replay.names) {
+        auto ship = MakeAstroShip(n);
+        if (!ship) {
+            error = "unknown ship '" + n + "'";
+            return false;
+        }
+        ships.emplace_back(std::move(ship));
+    }
+    match.compiledScripts = (replay.mode & ASTRO_REPLAY_COMPILED) != 0;
+    match.batchedScripts = (replay.mode & ASTRO_REPLAY_BATCHED) != 0;
+    match.simultaneousTurns = (replay.mode & ASTRO_REPLAY_SIMULTANEOUS) != 0;
+    match.Setup(std::move(ships), replay.seed);
+
+    // check at every keyframe and at the target turn
+    std::vector<AstroReplayShip> live, recorded;
+    while (true) {
+        bool check = (match.turn % ASTRO_REPLAY_KEYFRAME_INTERVAL == 0) || match.turn >= turn;
+        if (check) {
+            QuantizeReplayShips(match, live);
+            if (!replay.ShipsAt(match.turn, recorded)) {
+                error = "replay is corrupt at turn " + std::to_string(match.turn);
+                return false;
+            }
+            if (live != recorded) {
+                error = "replay diverged at turn " + std::to_string(match.turn);
+                return false;
+            }
+        }
+        if (match.turn >= turn) return true;
+        int before = match.turn;
+        match.Step();
+        if (match.turn == before) {
+            // the match finished early; Step() no longer advances it
+            error = "replay ended at turn " + std::to_string(match.turn) + " before turn " + std::to_string(turn);
+            return false;
+        }
+    }
+}
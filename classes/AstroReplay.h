@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct AstroMatch;
+
+// ===== AstroReplay: compact append-only match recording =====
+// A match is fully determined by its roster and seed, so the header stores just
+// those. Each turn then appends a small delta record per ship: a change mask, the
+// AstroShipEffect bits and zigzag-varint deltas of quantized kinematics. That is
+// enough to draw ship tracks or diff two runs without re-simulating, at a few
+// bytes per ship per turn. A keyframe with absolute values every
+// ASTRO_REPLAY_KEYFRAME_INTERVAL turns bounds the cost of seeking.
+//
+// Layout (all integers are LEB128 varints unless noted):
+//   "ASRP" u8 version, seed (u64 little endian), u8 turn mode (AstroReplayMode bits),
+//   ship count, per ship: name length + bytes
+//   records: u8 tag ('K' keyframe | 'D' delta), turn (keyframes only), per ship data
+static constexpr int ASTRO_REPLAY_VERSION = 2; // 2: turn mode in the header
+static constexpr int ASTRO_REPLAY_KEYFRAME_INTERVAL = 256;
+
+// How the recorded match ran its scripts; batched and simultaneous turns
+// resolve weapons differently, so a replay must be re-simulated the same way
+enum AstroReplayMode : uint8_t {
+    ASTRO_REPLAY_COMPILED = 1,
+    ASTRO_REPLAY_BATCHED = 2,
+    ASTRO_REPLAY_SIMULTANEOUS = 4,
+};
+
+// Quantized ship state as stored in a replay
+struct AstroReplayShip {
+    int32_t x = 0, y = 0;   // world units * 8
+    int32_t angle = 0;      // degrees * 16
+    int32_t hp = 0;
+    int32_t fuel = 0;       // fuel * 10
+    int32_t alive = 0;
+    int32_t effects = 0;    // AstroShipEffect bits
+
+    bool operator==(const AstroReplayShip& o) const {
+        return x == o.x && y == o.y && angle == o.angle && hp == o.hp &&
+               fuel == o.fuel && alive == o.alive && effects == o.effects;
+    }
+    bool operator!=(const AstroReplayShip& o) const { return !(*this == o); }
+};
+
+void QuantizeReplayShips(const AstroMatch& match, std::vector<AstroReplayShip>& out);
+
+struct AstroReplayWriter {
+    // start a new recording from a freshly set up match; if sink is given the
+    // bytes are streamed to it at every keyframe and on Flush()
+    void Begin(const AstroMatch& match, const std::vector<std::string>& names, std::ostream* sink = nullptr);
+    void RecordTurn(const AstroMatch& match);
+    void Flush();
+
+    int LastTurn() const { return _lastTurn; }
+    size_t Size() const { return _bytes.size(); }
+    const std::vector<uint8_t>& Bytes() const { return _bytes; }
+
+private:
+    std::vector<uint8_t> _bytes;
+    std::vector<AstroReplayShip> _prev;
+    std::vector<AstroReplayShip> _cur;
+    std::ostream* _sink = nullptr;
+    size_t _flushed = 0;
+    int _lastTurn = -1;
+};
+
+struct AstroReplayReader {
+    uint64_t seed = 0;
+    uint8_t mode = 0; // AstroReplayMode bits
+    std::vector<std::string> names;
+
+    bool Load(std::vector<uint8_t> bytes, std::string& error);
+    bool LoadFile(const std::string& path, std::string& error);
+
+    int LastTurn() const { return _lastTurn; }
+    // decode the recorded ship states for a turn, starting from the nearest keyframe
+    bool ShipsAt(int turn, std::vector<AstroReplayShip>& out) const;
+
+private:
+    struct Keyframe { int turn; size_t offset; };
+    std::vector<uint8_t> _bytes;
+    std::vector<Keyframe> _keyframes;
+    int _lastTurn = -1;
+};
+
+// Rebuild the recorded match in `match` and step it to `turn` by re-simulating
+// from the seed in the recorded turn mode. Keyframes and the target turn are checked against the recording,
+// so a mismatch (a changed ship script or rule) is reported rather than silently
+// diverging.
+bool AstroReplaySeek(const AstroReplayReader& replay, int turn, AstroMatch& match, std::string& error);
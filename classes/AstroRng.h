@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// ===== AstroRng: small seedable random stream (PCG32) =====
+// The std:: engines/distributions are not guaranteed to produce the same numbers
+// across standard libraries, and a single shared engine lets cosmetic effects
+// shift gameplay. Each arena owns a few of these, one per sub-system, all
+// derived from the match seed, so a seed replays a match exactly.
+struct AstroRng {
+    uint64_t state = 0;
+    uint64_t inc = 1;
+
+    // stream picks one of 2^63 independent sequences for the same seed
+    void Seed(uint64_t seed, uint64_t stream) {
+        state = 0;
+        inc = (stream << 1u) | 1u;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    uint32_t Next() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ull + inc;
+        uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+        uint32_t rot = (uint32_t)(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+    }
+
+    // uniform float in [0, 1)
+    float Float01() { return (float)(Next() >> 8) * (1.0f / 16777216.0f); }
+    // uniform float in [lo, hi)
+    float Uniform(float lo, float hi) { return lo + (hi - lo) * Float01(); }
+    // uniform int in [lo, hi] (inclusive, like std::uniform_int_distribution)
+    int Range(int lo, int hi) {
+        uint32_t span = (uint32_t)(hi - lo) + 1u;
+        return lo + (int)(((uint64_t)Next() * span) >> 32);
+    }
+};
+
+// Sub-stream ids; gameplay and cosmetic draws never share a sequence
+enum AstroRngStream {
+    ASTRO_RNG_ASTEROIDS = 1, // spawning, splitting and shapes (gameplay)
+    ASTRO_RNG_PARTICLES = 2, // particle bursts (cosmetic, drawn only by AstroEffects)
+    ASTRO_RNG_DEBRIS = 3,    // ship breakup debris (cosmetic, drawn only by AstroEffects)
+    ASTRO_RNG_SHAPES = 4     // asteroid shape library (fixed seed, shared by every match)
+};
@@ -0,0 +1,485 @@
+#include "AstroShip.h"
+#include "AstroArena.h"
+
+// ===== Link step =====
+// number of operands following each opcode in `code`
+static int OperandCount(int op) {
+    switch (op) {
+        case ASTRO_OP_THRUST: case ASTRO_OP_TURN_DEG: case ASTRO_OP_SIGNAL:
+        case ASTRO_OP_IF_SEEN: case ASTRO_OP_IF_SCAN_LE: case ASTRO_OP_IF_DAMAGED:
+        case ASTRO_OP_IF_HP_LE: case ASTRO_OP_IF_FUEL_LE:
+        case ASTRO_OP_IF_CAN_FIRE_PHASER: case ASTRO_OP_IF_CAN_FIRE_PHOTON:
+        case ASTRO_OP_JUMP: case ASTRO_OP_JUMP_IF_FALSE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+bool ShipBase::Link() {
+    linked = true;
+    compiledReady = false;
+    linkError.clear();
+    program.clear();
+
+    // pass 1: decode, remembering which code offset starts which instruction
+    std::vector<int> instrAt(code.size() + 1, -1);
+    for (size_t pc = 0; pc < code.size(); ) {
+        int op = code[pc];
+        if (op < ASTRO_OP_WAIT || op > ASTRO_OP_END) {
+            linkError = "unknown opcode " + std::to_string(op) + " at " + std::to_string(pc);
+            break;
+        }
+        int n = OperandCount(op);
+        if (pc + 1 + n > code.size()) {
+            linkError = "missing operand at " + std::to_string(pc);
+            break;
+        }
+        instrAt[pc] = (int)program.size();
+        AstroInstr in = { op, n ? code[pc + 1] : 0, 0.0f };
+        if (op == ASTRO_OP_THRUST) in.power = in.arg / 10.0f;
+        program.push_back(in);
+        pc += 1 + n;
+    }
+    // scripts that fall off the end stop there, as if they had an END
+    if (linkError.empty()) {
+        if (program.empty() || program.back().op != ASTRO_OP_END) {
+            program.push_back({ ASTRO_OP_END, 0, 0.0f });
+        }
+        instrAt[code.size()] = (int)program.size() - 1;
+    }
+
+    // pass 2: resolve jumps; only forward jumps are allowed, so every run ends
+    for (size_t pc = 0; linkError.empty() && pc < code.size(); pc += 1 + OperandCount(code[pc])) {
+        int op = code[pc];
+        if (op != ASTRO_OP_JUMP && op != ASTRO_OP_JUMP_IF_FALSE) continue;
+        int target = code[pc + 1];
+        if (target <= (int)pc || target > (int)code.size() || instrAt[target] < 0) {
+            linkError = "bad jump target " + std::to_string(target) + " at " + std::to_string(pc);
+            break;
+        }
+        program[instrAt[pc]].arg = instrAt[target];
+    }
+
+    if (!linkError.empty()) {
+        program.assign(1, { ASTRO_OP_END, 0, 0.0f });
+        return false;
+    }
+    return true;
+}
+
+// ===== VM implementation =====
+// Link() guarantees every path reaches END and every jump lands in program, so
+// neither backend bounds-checks the instruction pointer
+void ShipBase::Run(int turn) {
+    if (ASTRO_VM_USES_COMPUTED_GOTO) {
+        RunComputedGoto();
+    } else {
+        RunSwitch();
+    }
+}
+
+void ShipBase::RunSwitch() {
+    if (!linked) Link();
+    const AstroInstr* base = program.data();
+    const AstroInstr* ip = base;
+    bool flag = false;
+    for (;;) {
+        const AstroInstr& in = *ip++;
+        switch (in.op) {
+            case ASTRO_OP_WAIT:
+                break;
+            case ASTRO_OP_THRUST:
+                A->Thrust(id, in.power);
+                break;
+            case ASTRO_OP_TURN_DEG:
+                A->TurnDeg(id, in.arg);
+                break;
+            case ASTRO_OP_FIRE_PHASER:
+                A->FirePhaser(id);
+                break;
+            case ASTRO_OP_FIRE_PHOTON:
+                A->FirePhoton(id);
+                break;
+            case ASTRO_OP_SCAN:
+                A->Scan(id);
+                break;
+            case ASTRO_OP_SIGNAL:
+                A->Signal(id, in.arg);
+                break;
+            case ASTRO_OP_TURN_TO_SCAN:
+                A->TurnToScan(id);
+                break;
+            case ASTRO_OP_IF_SEEN:
+                flag = A->ships[id].scan_hit;
+                break;
+            case ASTRO_OP_IF_SCAN_LE:
+                flag = (A->ships[id].scan_hit && A->ships[id].scan_dist <= in.arg);
+                break;
+            case ASTRO_OP_IF_DAMAGED:
+                flag = (A->ships[id].hp < ASTRO_START_HP);
+                break;
+            case ASTRO_OP_IF_HP_LE:
+                flag = (A->ships[id].hp <= in.arg);
+                break;
+            case ASTRO_OP_IF_FUEL_LE:
+                flag = (A->ships[id].fuel <= in.arg);
+                break;
+            case ASTRO_OP_IF_CAN_FIRE_PHASER:
+                flag = (A->ships[id].phaser_cooldown == 0);
+                break;
+            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
+                flag = (A->ships[id].photon_cooldown == 0);
+                break;
+            case ASTRO_OP_JUMP_IF_FALSE:
+                if (!flag) ip = base + in.arg;
+                break;
+            case ASTRO_OP_JUMP:
+                ip = base + in.arg;
+                break;
+            case ASTRO_OP_END:
+            default:
+                return;
+        }
+    }
+}
+
+void ShipBase::RunComputedGoto() {
+#if ASTRO_VM_HAS_COMPUTED_GOTO
+    if (!linked) Link();
+    // one label per AstroOpCode, in enum order; Link() rejects anything else
+    static_assert(ASTRO_OP_END == 17, "update the dispatch table for new opcodes");
+    static const void* const labels[] = {
+        &&op_wait, &&op_thrust, &&op_turn_deg, &&op_fire_phaser,
+        &&op_fire_photon, &&op_scan, &&op_signal, &&op_turn_to_scan,
+        &&op_if_seen, &&op_if_scan_le, &&op_if_damaged, &&op_if_hp_le,
+        &&op_if_fuel_le, &&op_if_can_fire_phaser, &&op_if_can_fire_photon,
+        &&op_jump, &&op_jump_if_false, &&op_end
+    };
+    const AstroInstr* base = program.data();
+    const AstroInstr* ip = base;
+    const AstroInstr* in;
+    bool flag = false;
+    #define ASTRO_VM_NEXT() do { in = ip++; goto *labels[in->op]; } while (0)
+
+    ASTRO_VM_NEXT();
+op_wait:
+    ASTRO_VM_NEXT();
+op_thrust:
+    A->Thrust(id, in->power);
+    ASTRO_VM_NEXT();
+op_turn_deg:
+    A->TurnDeg(id, in->arg);
+    ASTRO_VM_NEXT();
+op_fire_phaser:
+    A->FirePhaser(id);
+    ASTRO_VM_NEXT();
+op_fire_photon:
+    A->FirePhoton(id);
+    ASTRO_VM_NEXT();
+op_scan:
+    A->Scan(id);
+    ASTRO_VM_NEXT();
+op_signal:
+    A->Signal(id, in->arg);
+    ASTRO_VM_NEXT();
+op_turn_to_scan:
+    A->TurnToScan(id);
+    ASTRO_VM_NEXT();
+op_if_seen:
+    flag = A->ships[id].scan_hit;
+    ASTRO_VM_NEXT();
+op_if_scan_le:
+    flag = (A->ships[id].scan_hit && A->ships[id].scan_dist <= in->arg);
+    ASTRO_VM_NEXT();
+op_if_damaged:
+    flag = (A->ships[id].hp < ASTRO_START_HP);
+    ASTRO_VM_NEXT();
+op_if_hp_le:
+    flag = (A->ships[id].hp <= in->arg);
+    ASTRO_VM_NEXT();
+op_if_fuel_le:
+    flag = (A->ships[id].fuel <= in->arg);
+    ASTRO_VM_NEXT();
+op_if_can_fire_phaser:
+    flag = (A->ships[id].phaser_cooldown == 0);
+    ASTRO_VM_NEXT();
+op_if_can_fire_photon:
+    flag = (A->ships[id].photon_cooldown == 0);
+    ASTRO_VM_NEXT();
+op_jump:
+    ip = base + in->arg;
+    ASTRO_VM_NEXT();
+op_jump_if_false:
+    if (!flag) ip = base + in->arg;
+    ASTRO_VM_NEXT();
+op_end:
+    return;
+    #undef ASTRO_VM_NEXT
+#else
+    RunSwitch();
+#endif
+}
+
+// ===== Closure compilation =====
+void ShipBase::Compile() {
+    if (!linked) Link();
+    compiled.assign(program.size(), AstroCompiledOp());
+    // closure to continue with at instruction i: jumps are followed at compile
+    // time and END becomes nullptr. Link() only allows forward jumps, so this ends.
+    auto cont = [this](int i) -> const AstroCompiledOp* {
+        while (program[i].op == ASTRO_OP_JUMP) i = program[i].arg;
+        return program[i].op == ASTRO_OP_END ? nullptr : &compiled[i];
+    };
+    // the last instruction is always END, so i + 1 is in range for everything else
+    for (int i = 0; i < (int)program.size(); ++i) {
+        const AstroInstr in = program[i];
+        const AstroCompiledOp* next = (in.op == ASTRO_OP_END) ? nullptr : cont(i + 1);
+        switch (in.op) {
+            case ASTRO_OP_WAIT:
+                compiled[i] = [next](ShipBase& s, bool f) { if (next) (*next)(s, f); };
+                break;
+            case ASTRO_OP_THRUST: {
+                float power = in.power;
+                compiled[i] = [next, power](ShipBase& s, bool f) { s.A->Thrust(s.id, power); if (next) (*next)(s, f); };
+                break;
+            }
+            case ASTRO_OP_TURN_DEG: {
+                int degrees = in.arg;
+                compiled[i] = [next, degrees](ShipBase& s, bool f) { s.A->TurnDeg(s.id, degrees); if (next) (*next)(s, f); };
+                break;
+            }
+            case ASTRO_OP_FIRE_PHASER:
+                compiled[i] = [next](ShipBase& s, bool f) { s.A->FirePhaser(s.id); if (next) (*next)(s, f); };
+                break;
+            case ASTRO_OP_FIRE_PHOTON:
+                compiled[i] = [next](ShipBase& s, bool f) { s.A->FirePhoton(s.id); if (next) (*next)(s, f); };
+                break;
+            case ASTRO_OP_SCAN:
+                compiled[i] = [next](ShipBase& s, bool f) { s.A->Scan(s.id); if (next) (*next)(s, f); };
+                break;
+            case ASTRO_OP_SIGNAL: {
+                int value = in.arg;
+                compiled[i] = [next, value](ShipBase& s, bool f) { s.A->Signal(s.id, value); if (next) (*next)(s, f); };
+                break;
+            }
+            case ASTRO_OP_TURN_TO_SCAN:
+                compiled[i] = [next](ShipBase& s, bool f) { s.A->TurnToScan(s.id); if (next) (*next)(s, f); };
+                break;
+            case ASTRO_OP_IF_SEEN:
+                compiled[i] = [next](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].scan_hit;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            case ASTRO_OP_IF_SCAN_LE: {
+                int range = in.arg;
+                compiled[i] = [next, range](ShipBase& s, bool) {
+                    const auto& st = s.A->ships[s.id];
+                    bool f = st.scan_hit && st.scan_dist <= range;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            }
+            case ASTRO_OP_IF_DAMAGED:
+                compiled[i] = [next](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].hp < ASTRO_START_HP;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            case ASTRO_OP_IF_HP_LE: {
+                int hp = in.arg;
+                compiled[i] = [next, hp](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].hp <= hp;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            }
+            case ASTRO_OP_IF_FUEL_LE: {
+                int fuel = in.arg;
+                compiled[i] = [next, fuel](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].fuel <= fuel;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            }
+            case ASTRO_OP_IF_CAN_FIRE_PHASER:
+                compiled[i] = [next](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].phaser_cooldown == 0;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            case ASTRO_OP_IF_CAN_FIRE_PHOTON:
+                compiled[i] = [next](ShipBase& s, bool) {
+                    bool f = s.A->ships[s.id].photon_cooldown == 0;
+                    if (next) (*next)(s, f);
+                };
+                break;
+            case ASTRO_OP_JUMP_IF_FALSE: {
+                const AstroCompiledOp* target = cont(in.arg);
+                compiled[i] = [next, target](ShipBase& s, bool f) {
+                    const AstroCompiledOp* k = f ? next : target;
+                    if (k) (*k)(s, f);
+                };
+                break;
+            }
+            default:
+                break; // JUMP and END are resolved by cont() and never entered
+        }
+    }
+    compiledEntry = cont(0);
+    compiledReady = true;
+}
+
+void ShipBase::RunCompiled() {
+    if (!compiledReady) Compile();
+    if (compiledEntry) (*compiledEntry)(*this, false);
+}
+
+// ===== Sample ship implementations =====
+int HunterShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        // Always turn toward and pursue what we see
+        TURN_TO_SCAN();
+        IF_SCAN_LE(500) {  // within phaser range: shoot
+            IF_SHIP_CAN_FIRE_PHASER() {
+                FIRE_PHASER();
+            }
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();
+            }
+        }
+        THRUST(2);  // close distance if not in range
+    } ELSE() {
+        THRUST(4);
+    }
+    IF_SHIP_FUEL_LE(40) {
+        SCAN();
+        IF_SCAN_LE(300) {  // Increased from 100 - look for fuel further away
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+int DroneShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
+            // Thrust away from threat
+            THRUST(3);
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();  // Fire while retreating
+            }
+        }
+    }
+    IF_SHIP_HP_LE(6) {  // Emergency threshold
+        THRUST(2);
+    }
+    IF_SHIP_FUEL_LE(35) {
+        SCAN();
+        IF_SCAN_LE(200) {  // Increased from 100
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+int MinerShip::SetupShip() {
+    // Move toward scanned objects and fire when close
+    SCAN();
+    IF_SEEN() {
+        TURN_TO_SCAN();
+        THRUST(2);
+        IF_SCAN_LE(150) {  // close range work
+            IF_SHIP_CAN_FIRE_PHASER() {
+                FIRE_PHASER();
+            }
+        }
+    } ELSE() {
+        THRUST(4);
+    }
+    IF_SHIP_DAMAGED() {
+        SCAN();
+        IF_SEEN() {
+            IF_SCAN_LE(350) {  // Increased from 200 - flee earlier
+                THRUST(3);
+            }
+        }
+    }
+    return Finalize();
+}
+
+int GraemeShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        IF_SCAN_LE(450) {  // Increased from 400 - be more cautious
+            // Thrust away from threat
+            THRUST(3);
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();  // Fire while retreating
+            }
+        }
+    }
+    IF_SHIP_HP_LE(6) {  // Emergency threshold
+        THRUST(2);
+    }
+    IF_SHIP_FUEL_LE(35) {
+        SCAN();
+        IF_SCAN_LE(200) {  // Increased from 100
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+int BeepBoopShip::SetupShip() {
+    SCAN();
+    IF_SEEN() {
+        TURN_TO_SCAN();
+        IF_SCAN_LE(450) {
+            // Thrust away from threat
+            THRUST(3);
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();  // Fire while retreating
+            }
+            IF_SHIP_CAN_FIRE_PHOTON() {
+                FIRE_PHOTON();
+            }
+        }
+    }
+    IF_SHIP_HP_LE(6) {  // Emergency threshold
+        THRUST(2);
+    }
+    IF_SHIP_FUEL_LE(35) {
+        SCAN();
+        IF_SCAN_LE(200) {  // Increased from 100
+            TURN_TO_SCAN();
+            THRUST(2);
+        }
+    }
+    return Finalize();
+}
+
+// ===== Ship roster =====
+const std::vector<AstroShipEntry>& AstroShipRoster() {
+    static const std::vector<AstroShipEntry> roster = {
+        { "Hunter",   []{ return std::unique_ptr<ShipBase>(new HunterShip()); } },
+        { "Drone",    []{ return std::unique_ptr<ShipBase>(new DroneShip()); } },
+        { "Miner",    []{ return std::unique_ptr<ShipBase>(new MinerShip()); } },
+        { "Graeme",   []{ return std::unique_ptr<ShipBase>(new GraemeShip()); } },
+        { "BeepBoop", []{ return std::unique_ptr<ShipBase>(new BeepBoopShip()); } },
+    };
+    return roster;
+}
+
+std::unique_ptr<ShipBase> MakeAstroShip(const std::string& name) {
+    for (const auto& e : AstroShipRoster()) {
+        if (e.name == name) return e.make();
+    }
+    return nullptr;
+}
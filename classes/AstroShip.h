@@ -0,0 +1,185 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AstroTypes.h"
+#include "AstroArena.h"
+
+// ===== Linked instruction =====
+// Fixed-width, pre-decoded form of one opcode, produced by ShipBase::Link():
+// dummy parameters are dropped, THRUST power is already scaled and jump targets
+// are indices into the instruction array rather than offsets into `code`.
+struct AstroInstr {
+    int op;        // AstroOpCode
+    int arg;       // degrees / signal / threshold, or jump target
+    float power;   // THRUST only
+};
+
+// ===== VM dispatch =====
+// Run() dispatches with computed goto (GCC/Clang labels-as-values) unless the
+// build defines ASTRO_VM_SWITCH_DISPATCH (CMake: -DASTRO_VM_COMPUTED_GOTO=OFF)
+// or the compiler lacks the extension. Both backends are always built so
+// astro_sim --vm-bench can compare them on the current platform.
+#if defined(__GNUC__)
+#define ASTRO_VM_HAS_COMPUTED_GOTO 1
+#else
+#define ASTRO_VM_HAS_COMPUTED_GOTO 0
+#endif
+#if ASTRO_VM_HAS_COMPUTED_GOTO && !defined(ASTRO_VM_SWITCH_DISPATCH)
+static constexpr bool ASTRO_VM_USES_COMPUTED_GOTO = true;
+#else
+static constexpr bool ASTRO_VM_USES_COMPUTED_GOTO = false;
+#endif
+
+// ===== Compiled script =====
+// ShipBase::Compile() turns a linked program into a chain of closures, one per
+// instruction, each calling the arena directly and then its continuation, so
+// running a compiled script does no opcode dispatch. The flag set by IF_*
+// conditions is threaded through as an argument.
+struct ShipBase;
+using AstroCompiledOp = std::function<void(ShipBase&, bool)>;
+
+// ===== ShipBase: tiny VM with space combat Domain-Specific Language =====
+struct ShipBase {
+    std::vector<int> code;
+    std::vector<float> floatParams; // for storing float parameters like thrust power
+    int script_cost = 0;
+    std::string name = "Ship";
+    struct IfContext { int jumpIfFalseIndex=-1; int jumpToEndIndex=-1; };
+    std::vector<IfContext> _ifCtx;
+
+   struct IfBlock {
+        ShipBase* self; IfBlock(ShipBase* s, AstroOpCode cond, int param): self(s){
+            self->code.push_back(cond); self->code.push_back(param);
+            self->code.push_back(ASTRO_OP_JUMP_IF_FALSE); self->code.push_back(0); // placeholder
+            ShipBase::IfContext ctx; ctx.jumpIfFalseIndex = (int)self->code.size()-1; ctx.jumpToEndIndex = -1;
+            self->_ifCtx.push_back(ctx);
+        }
+        ~IfBlock(){
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                // If no ELSE() was emitted, patch false-jump to end of IF block
+                if (ctx.jumpToEndIndex == -1){
+                    self->code[ctx.jumpIfFalseIndex] = (int)self->code.size();
+                }
+                self->_ifCtx.pop_back();
+            }
+        }
+        explicit operator bool() const { return true; }
+    };
+    struct ElseBlock {
+        ShipBase* self;
+        ElseBlock(ShipBase* s): self(s){
+            // Begin ELSE: jump over else body, patch IF's false to here
+            self->code.push_back(ASTRO_OP_JUMP); self->code.push_back(0); // placeholder to end of else
+            int jumpToEndIdx = (int)self->code.size()-1;
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                self->code[ctx.jumpIfFalseIndex] = (int)self->code.size(); // start of ELSE
+                ctx.jumpToEndIndex = jumpToEndIdx;
+            }
+        }
+        ~ElseBlock(){
+            if (!self->_ifCtx.empty()){
+                ShipBase::IfContext &ctx = self->_ifCtx.back();
+                if (ctx.jumpToEndIndex != -1){
+                    self->code[ctx.jumpToEndIndex] = (int)self->code.size(); // end of ELSE
+                }
+            }
+        }
+        explicit operator bool() const { return true; }
+    };
+
+    // DSL: bot coders will use these in SetupShip()
+    #define THRUST(P)    do{ code.push_back(ASTRO_OP_THRUST); code.push_back((int)((P)*10)); script_cost += ASTRO_COST_THRUST; }while(0)
+    #define TURN_DEG(D)  do{ code.push_back(ASTRO_OP_TURN_DEG); code.push_back((D)); script_cost += ASTRO_COST_TURN; }while(0)
+    #define FIRE_PHASER() do{ code.push_back(ASTRO_OP_FIRE_PHASER); script_cost += ASTRO_COST_PHASER; }while(0)
+    #define FIRE_PHOTON() do{ code.push_back(ASTRO_OP_FIRE_PHOTON); script_cost += ASTRO_COST_PHOTON; }while(0)
+    #define SCAN()       do{ code.push_back(ASTRO_OP_SCAN); script_cost += ASTRO_COST_SCAN; }while(0)
+    #define SIGNAL(V)    do{ code.push_back(ASTRO_OP_SIGNAL); code.push_back((V)); script_cost += ASTRO_COST_SIGNAL; }while(0)
+    #define WAIT_()      do{ code.push_back(ASTRO_OP_WAIT); script_cost += ASTRO_COST_WAIT; }while(0)
+    #define TURN_TO_SCAN() do{ code.push_back(ASTRO_OP_TURN_TO_SCAN); script_cost += ASTRO_COST_TURN; }while(0)
+
+    #define IF_SEEN()      if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SEEN, 0})
+    #define IF_SCAN_LE(R)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_SCAN_LE, (R)})
+    #define IF_SHIP_DAMAGED()   if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_DAMAGED, 0})
+    #define IF_SHIP_HP_LE(N)    if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_HP_LE, (N)})
+    #define IF_SHIP_FUEL_LE(N)  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_FUEL_LE, (N)})
+    #define IF_SHIP_CAN_FIRE_PHASER()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHASER, 0})
+    #define IF_SHIP_CAN_FIRE_PHOTON()  if (IfBlock _cb##__LINE__{this, ASTRO_OP_IF_CAN_FIRE_PHOTON, 0})
+    #define ELSE() else if (ElseBlock _cb##__LINE__{this})
+
+    int Finalize() { code.push_back(ASTRO_OP_END); Link(); return script_cost; }
+
+    // Verify `code` (known opcodes, complete operands, forward jumps onto
+    // instruction boundaries) and lower it into `program`. A rejected script is
+    // replaced by a lone END, so the ship idles, and the reason is kept in linkError.
+    bool Link();
+    std::vector<AstroInstr> program;
+    std::string linkError;
+    bool linked = false;
+
+    // hooks provided by Arena at runtime
+    AstroArena* A = nullptr;
+    int id = -1;
+    virtual int SetupShip() = 0; // bot coders will implement this
+    ShipBase() = default;
+    virtual ~ShipBase() = default;
+    // Compile()'s closures point into `compiled`, so a copy would run the original's chain
+    ShipBase(const ShipBase&) = delete;
+    ShipBase& operator=(const ShipBase&) = delete;
+
+    // interpreter; runs `program`, linking first if SetupShip() skipped Finalize()
+    void Run(int turn);
+    // the two dispatch backends behind Run(); RunComputedGoto() falls back to
+    // the switch when the compiler has no labels-as-values
+    void RunSwitch();
+    void RunComputedGoto();
+
+    // closure-compiled alternative to the interpreter, which stays the reference
+    // (astro_sim --vm-diff checks the two agree); RunCompiled() compiles on first use
+    void Compile();
+    void RunCompiled();
+    std::vector<AstroCompiledOp> compiled; // closures point into this vector, so ships are never copied
+    const AstroCompiledOp* compiledEntry = nullptr; // nullptr: script does nothing
+    bool compiledReady = false;
+};
+
+// ===== Sample ships =====
+struct HunterShip : ShipBase {
+    HunterShip() { name = "Hunter"; }
+    int SetupShip() override;
+};
+
+struct DroneShip : ShipBase {
+    DroneShip() { name = "Drone"; }
+    int SetupShip() override;
+};
+
+struct MinerShip : ShipBase {
+    MinerShip() { name = "Miner"; }
+    int SetupShip() override;
+};
+
+struct GraemeShip : ShipBase {
+    GraemeShip() { name = "Graeme"; }
+    int SetupShip() override;
+};
+
+struct BeepBoopShip : ShipBase {
+    BeepBoopShip() { name = "BeepBoop";}
+    int SetupShip() override;
+};
+
+// ===== Ship roster =====
+// Every ship type that can be entered into a match by name. Add user ships here
+// so the viewer, astro_sim and the tournament runner can all construct them.
+struct AstroShipEntry {
+    std::string name;
+    std::function<std::unique_ptr<ShipBase>()> make;
+};
+const std::vector<AstroShipEntry>& AstroShipRoster();
+std::unique_ptr<ShipBase> MakeAstroShip(const std::string& name); // nullptr if unknown
@@ -0,0 +1,240 @@
+#include "AstroSimThread.h"
+#include <algorithm>
+#include <cstdio>
+
+AstroSimThread::AstroSimThread() {
+    match.arena.log = [this](const std::string& line) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _log.push_back(line);
+    };
+    match.arena.recordEvents = true;
+    _steppedAt = std::chrono::steady_clock::now();
+    _worker = std::thread([this] { WorkerLoop(); });
+}
+
+AstroSimThread::~AstroSimThread() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    _worker.join();
+}
+
+// ===== Commands =====
+void AstroSimThread::Post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _commands.push_back(std::move(fn));
+    }
+    _wake.notify_all();
+}
+
+void AstroSimThread::Call(const std::function<void()>& fn) {
+    bool done = false;
+    Post([&] {
+        fn();
+        std::lock_guard<std::mutex> lock(_mutex);
+        done = true;
+        _finished.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [&] { return done; });
+}
+
+void AstroSimThread::Start(std::vector<std::unique_ptr<ShipBase>> roster, uint64_t seed) {
+    // std::function needs a copyable callable, so the roster rides in a shared_ptr
+    auto ships = std::make_shared<std::vector<std::unique_ptr<ShipBase>>>(std::move(roster));
+    Post([this, ships, seed] {
+        match.Setup(std::move(*ships), seed);
+        std::vector<std::string> names;
+        for (const auto& s : match.ships) names.push_back(s->name);
+        replay.Begin(match, names);
+        Restarted();
+    });
+}
+
+void AstroSimThread::Restarted() {
+    effects.Reset(match.arena.matchSeed, match.ships.size());
+    prevShips = match.arena.ships;
+    _clock.accumulator = 0.0;
+    _steppedAt = std::chrono::steady_clock::now();
+}
+
+void AstroSimThread::FastForward(int turns) {
+    Post([this, turns] {
+        if (!match.running) return;
+        _ffFrom = match.turn;
+        _ffTarget = turns > 0 ? std::min(match.turn + turns, ASTRO_MAX_TURNS) : ASTRO_MAX_TURNS;
+        _ffStart = std::chrono::steady_clock::now();
+        // nothing is drawn until the target, so there is nothing to spawn effects for
+        match.arena.recordEvents = false;
+        effects.Clear();
+    });
+}
+
+void AstroSimThread::CancelFastForward() {
+    Post([this] {
+        if (_ffTarget >= 0) EndFastForward();
+    });
+}
+
+void AstroSimThread::SetClock(const AstroClock& settings) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_clockSettings.tickRate == settings.tickRate && _clockSettings.maxCatchUp == settings.maxCatchUp &&
+            _clockSettings.turbo == settings.turbo && _clockSettings.frameBudgetMs == settings.frameBudgetMs) {
+            return;
+        }
+        _clockSettings = settings;
+        _clockChanged = true;
+    }
+    _wake.notify_all();
+}
+
+void AstroSimThread::DrainLog(std::vector<std::string>& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& line : _log) out.push_back(std::move(line));
+    _log.clear();
+}
+
+// ===== Worker =====
+bool AstroSimThread::StepTurn() {
+    if (!match.running) return false;
+    prevShips = match.arena.ships; // same size every turn, so no allocation
+    match.arena.renderScale = _renderScale.load(std::memory_order_relaxed);
+    match.Step();
+    _steppedAt = std::chrono::steady_clock::now();
+    if (match.turn > ASTRO_MAX_TURNS) return true;
+    effects.Update();
+    effects.Apply(match.arena);
+    replay.RecordTurn(match);
+    return true;
+}
+
+void AstroSimThread::FastForwardSlice() {
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        // check the clock every few turns; a turn is only microseconds
+        for (int i = 0; i < 32; ++i) {
+            if (!match.running || match.turn >= _ffTarget) {
+                EndFastForward();
+                return;
+            }
+            match.Step();
+            if (match.turn <= ASTRO_MAX_TURNS) replay.RecordTurn(match);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (ms >= FAST_FORWARD_SLICE_MS) return;
+    }
+}
+
+void AstroSimThread::EndFastForward() {
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - _ffStart).count();
+    int turns = match.turn - _ffFrom;
+    _ffTarget = -1;
+    match.arena.recordEvents = true;
+    match.arena.events.clear();
+    Restarted();
+    if (match.arena.log) {
+        char rate[64];
+        std::snprintf(rate, sizeof(rate), "%.0f", secs > 0.0 ? turns / secs : 0.0);
+        match.arena.log("Fast-forwarded " + std::to_string(turns) + " turns to turn " + std::to_string(match.turn) +
+                        " (" + rate + " turns/s)");
+    }
+}
+
+void AstroSimThread::WorkerLoop() {
+    auto last = std::chrono::steady_clock::now();
+    Publish();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            // sleep until the next turn is due, a command arrives or we stop;
+            // a finished match (or none yet) only wakes for commands
+            auto ready = [this] { return _stop || !_commands.empty() || _clockChanged; };
+            if (_ffTarget >= 0) {
+                // fast-forwarding: only pick up what is queued
+            } else if (!match.running) {
+                _wake.wait(lock, ready);
+            } else if (!_clock.turbo) {
+                double interval = 1.0 / std::max(_clock.tickRate, 0.001);
+                auto due = std::chrono::duration<double>(std::max(interval - _clock.accumulator, 0.0));
+                _wake.wait_until(lock, last + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due), ready);
+            }
+            if (_stop) return;
+            _running.swap(_commands);
+            if (_clockChanged) {
+                _clock.tickRate = _clockSettings.tickRate;
+                _clock.maxCatchUp = _clockSettings.maxCatchUp;
+                _clock.turbo = _clockSettings.turbo;
+                _clock.frameBudgetMs = _clockSettings.frameBudgetMs;
+                _clockChanged = false;
+            }
+        }
+        bool changed = !_running.empty();
+        for (auto& fn : _running) fn();
+        _running.clear();
+        if (_ffTarget >= 0) {
+            FastForwardSlice();
+            Publish();
+            last = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+        if (_clock.Advance(elapsed, [this] { return StepTurn(); }) > 0) changed = true;
+        if (changed) Publish();
+    }
+}
+
+// ===== Triple buffer =====
+void AstroSimThread::Publish() {
+    AstroRenderFrame& f = _frames[_back];
+    f.serial = ++_serial;
+    f.turn = match.turn;
+    f.seed = match.arena.matchSeed;
+    f.running = match.running;
+    f.winner = match.Winner();
+    f.draw = match.IsDraw();
+    f.steppedAt = _steppedAt;
+
+    f.shipNames.resize(match.ships.size());
+    for (size_t i = 0; i < match.ships.size(); ++i) {
+        if (f.shipNames[i] != match.ships[i]->name) f.shipNames[i] = match.ships[i]->name;
+    }
+    f.ships = match.arena.ships;
+    f.prevShips = prevShips;
+    for (auto& s : f.ships) s.ship = nullptr;
+    for (auto& s : f.prevShips) s.ship = nullptr;
+    f.asteroids = match.arena.asteroids;
+    f.torpedoes = match.arena.torpedoes;
+    f.phaserBeams = effects.phaserBeams;
+    f.particles = effects.particles;
+    f.shipDebris = effects.shipDebris;
+
+    f.replayTurns = replay.LastTurn();
+    f.replayBytes = replay.Size();
+    f.ticks = _clock.lastTicks;
+    f.dropped = _clock.droppedTicks;
+
+    f.fastForwarding = _ffTarget >= 0;
+    f.ffFrom = _ffFrom;
+    f.ffTarget = _ffTarget;
+    f.ffTurnsPerSec = 0.0;
+    if (f.fastForwarding) {
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - _ffStart).count();
+        if (secs > 0.0) f.ffTurnsPerSec = (match.turn - _ffFrom) / secs;
+    }
+
+    _back = _middle.exchange((uint8_t)(_back | FRESH), std::memory_order_acq_rel) & 3;
+}
+
+const AstroRenderFrame& AstroSimThread::Acquire() {
+    if (_middle.load(std::memory_order_relaxed) & FRESH) {
+        _front = _middle.exchange((uint8_t)_front, std::memory_order_acq_rel) & 3;
+    }
+    return _frames[_front];
+}
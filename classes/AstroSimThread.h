@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AstroClock.h"
+#include "AstroEffects.h"
+#include "AstroMatch.h"
+#include "AstroReplay.h"
+
+// ===== AstroRenderFrame: what a renderer needs from one moment of a match =====
+// Plain copies, so a frame stays valid however far the simulation has moved
+// on. Ship states have their `ship` pointer cleared (the programs belong to
+// the simulation thread); names are in shipNames.
+struct AstroRenderFrame {
+    uint64_t serial = 0; // increases with every published frame
+    int turn = 0;
+    uint64_t seed = 0;
+    bool running = false;
+    int winner = -1;
+    bool draw = false;
+    std::chrono::steady_clock::time_point steppedAt; // when `turn` was stepped, for interpolation
+
+    std::vector<std::string> shipNames;
+    std::vector<AstroArena::ShipState> ships;
+    std::vector<AstroArena::ShipState> prevShips; // before the last turn
+    std::vector<Asteroid> asteroids;
+    std::vector<PhotonTorpedo> torpedoes;
+    std::vector<PhaserBeam> phaserBeams;
+    AstroParticles particles;
+    AstroDebris shipDebris;
+
+    int replayTurns = -1;
+    size_t replayBytes = 0;
+    int ticks = 0;         // turns run by the clock's last Advance()
+    long long dropped = 0; // turns skipped by the catch-up limit
+
+    // while a fast-forward runs, frames only report its progress
+    bool fastForwarding = false;
+    int ffFrom = 0;
+    int ffTarget = 0;           // ASTRO_MAX_TURNS when running to the end
+    double ffTurnsPerSec = 0.0;
+};
+
+// ===== AstroSimThread: a match stepped on its own thread =====
+// The worker runs the match, its effects and its replay on an AstroClock, and
+// after each batch of turns publishes an AstroRenderFrame through a triple
+// buffer: it fills the back frame and swaps it with the middle one in a
+// single atomic exchange, and the renderer swaps its front frame with the
+// middle one when a newer frame is there. Neither side ever waits for the
+// other, so a slow turn (a mass asteroid break) cannot stall the UI and a
+// slow frame cannot stall the match. The frames are reused, so a warmed-up
+// publish does not allocate either.
+//
+// Everything else goes through commands: Post() queues a function that runs
+// on the worker between turns, Call() does the same and waits for it.
+//
+// A fast-forward steps the match flat out with event recording off and no
+// effects, in slices of FAST_FORWARD_SLICE_MS. Between slices it publishes a
+// progress frame and runs any commands, so it can be cancelled.
+struct AstroSimThread {
+    AstroSimThread();
+    ~AstroSimThread();
+    AstroSimThread(const AstroSimThread&) = delete;
+    AstroSimThread& operator=(const AstroSimThread&) = delete;
+
+    // worker-side state: only touch it from inside Post()/Call()
+    AstroMatch match;
+    AstroEffects effects;
+    AstroReplayWriter replay;
+    std::vector<AstroArena::ShipState> prevShips;
+
+    void Post(std::function<void()> fn);
+    void Call(const std::function<void()>& fn); // never from inside a command
+
+    // set up a fresh match (and its replay) on the worker
+    void Start(std::vector<std::unique_ptr<ShipBase>> roster, uint64_t seed);
+    // call after restoring or seeking `match`, from inside a command
+    void Restarted();
+    // step `turns` turns (0: to the end of the match) as fast as the CPU
+    // allows, without effects, then resume on the clock
+    void FastForward(int turns);
+    void CancelFastForward();
+
+    // renderer side
+    void SetClock(const AstroClock& settings); // rate, catch-up limit and turbo
+    void SetRenderScale(float scale) { _renderScale.store(scale, std::memory_order_relaxed); }
+    // the newest published frame; valid until the next Acquire()
+    const AstroRenderFrame& Acquire();
+    // move the log lines written since the last call to the end of `out`
+    void DrainLog(std::vector<std::string>& out);
+
+private:
+    void WorkerLoop();
+    bool StepTurn();
+    void FastForwardSlice();
+    void EndFastForward();
+    void Publish();
+
+    std::thread _worker;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _finished; // a Call() command has run
+    std::vector<std::function<void()>> _commands;
+    std::vector<std::function<void()>> _running; // commands being run by the worker
+    AstroClock _clockSettings;
+    bool _clockChanged = false;
+    std::vector<std::string> _log;
+    bool _stop = false;
+
+    // worker only
+    AstroClock _clock;
+    uint64_t _serial = 0;
+    std::chrono::steady_clock::time_point _steppedAt;
+    int _ffTarget = -1; // turn to stop fast-forwarding at, -1 when not
+    int _ffFrom = 0;
+    std::chrono::steady_clock::time_point _ffStart;
+
+    // triple buffer: the worker owns _back, the renderer _front, and _middle
+    // holds the third index plus FRESH when it has not been acquired yet
+    static constexpr uint8_t FRESH = 4;
+    static constexpr double FAST_FORWARD_SLICE_MS = 16.0;
+    AstroRenderFrame _frames[3];
+    int _back = 0;
+    int _front = 2;
+    std::atomic<uint8_t> _middle{1};
+    std::atomic<float> _renderScale{1.0f};
+};
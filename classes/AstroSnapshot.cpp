@@ -0,0 +1,207 @@
+#include "AstroSnapshot.h"
+#include "AstroMatch.h"
+#include <cstring>
+
+// ===== Encoding helpers =====
+// The same Visit* functions drive both directions, so the save and load field
+// orders cannot drift apart. They are templated on the visited type as well,
+// so saving walks a const match and loading a mutable one.
+struct SnapshotWriter {
+    static constexpr bool SAVING = true;
+    std::vector<uint8_t>& out;
+    size_t n = 0; // bytes written; out is grown ahead of n and trimmed at the end
+
+    uint8_t* Reserve(size_t bytes) {
+        if (n + bytes > out.size()) out.resize((n + bytes) * 2);
+        uint8_t* p = out.data() + n;
+        n += bytes;
+        return p;
+    }
+    void U32(uint32_t v) {
+        uint8_t* b = Reserve(4);
+        b[0] = (uint8_t)v; b[1] = (uint8_t)(v >> 8); b[2] = (uint8_t)(v >> 16); b[3] = (uint8_t)(v >> 24);
+    }
+    void operator()(const uint64_t& v) { U32((uint32_t)v); U32((uint32_t)(v >> 32)); }
+    void operator()(const uint32_t& v) { U32(v); }
+    void operator()(const int& v) { U32((uint32_t)v); }
+    void operator()(const float& v) { uint32_t u; std::memcpy(&u, &v, 4); U32(u); }
+    void operator()(const uint8_t& v) { *Reserve(1) = v; }
+    void operator()(const bool& v) { *Reserve(1) = v ? 1 : 0; }
+    void operator()(const std::string& s) {
+        U32((uint32_t)s.size());
+        if (!s.empty()) std::memcpy(Reserve(s.size()), s.data(), s.size());
+    }
+    void Fail() {}
+    // list header; returns the element count to visit
+    uint32_t Count(size_t count, size_t) { U32((uint32_t)count); return (uint32_t)count; }
+};
+
+struct SnapshotReader {
+    static constexpr bool SAVING = false;
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint32_t U32() {
+        if (end - p < 4) { ok = false; p = end; return 0; }
+        uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        p += 4;
+        return v;
+    }
+    void operator()(uint64_t& v) { uint64_t lo = U32(); v = lo | ((uint64_t)U32() << 32); }
+    void operator()(uint32_t& v) { v = U32(); }
+    void operator()(int& v) { v = (int)U32(); }
+    void operator()(float& v) { uint32_t u = U32(); std::memcpy(&v, &u, 4); }
+    void operator()(uint8_t& v) {
+        if (p >= end) { ok = false; return; }
+        v = *p++;
+    }
+    void operator()(bool& v) { uint8_t b = 0; (*this)(b); v = b != 0; }
+    void operator()(std::string& s) {
+        uint32_t n = U32();
+        if ((size_t)(end - p) < n) { ok = false; p = end; return; }
+        s.assign((const char*)p, n);
+        p += n;
+    }
+    // list header; rejects counts the remaining bytes cannot possibly hold
+    uint32_t Count(size_t, size_t minElemBytes) {
+        uint32_t n = U32();
+        if (minElemBytes && n > (size_t)(end - p) / minElemBytes) { ok = false; p = end; return 0; }
+        return n;
+    }
+    void Fail() { ok = false; p = end; }
+};
+
+template <class Ar, class V, class F>
+static void VisitList(Ar& ar, V& v, size_t minElemBytes, F visit) {
+    uint32_t n = ar.Count(v.size(), minElemBytes);
+    if constexpr (!Ar::SAVING) v.resize(n);
+    for (auto& e : v) visit(ar, e);
+}
+
+template <class Ar, class R>
+static void VisitRng(Ar& ar, R& r) {
+    ar(r.state); ar(r.inc);
+}
+
+template <class Ar, class S>
+static void VisitShip(Ar& ar, S& s) {
+    ar(s.x); ar(s.y); ar(s.vx); ar(s.vy);
+    ar(s.angle); ar(s.targetAngle);
+    ar(s.hp); ar(s.fuel); ar(s.alive);
+    ar(s.scan_dist); ar(s.scan_angle); ar(s.scan_hit);
+    ar(s.phaser_cooldown); ar(s.photon_cooldown);
+    ar(s.signal); ar(s.effects); ar(s.color);
+}
+
+template <class Ar, class T>
+static void VisitTorpedo(Ar& ar, T& t) {
+    ar(t.x); ar(t.y); ar(t.vx); ar(t.vy);
+    ar(t.lifetime); ar(t.damage); ar(t.owner); ar(t.alive);
+    ar(t.anim); ar(t.prevX); ar(t.prevY);
+}
+
+template <class Ar, class A>
+static void VisitAsteroid(Ar& ar, A& a) {
+    ar(a.x); ar(a.y); ar(a.vx); ar(a.vy); ar(a.size);
+    ar(a.hp); ar(a.alive);
+    ar(a.shape); // index into the shape library, which every build generates identically
+    if constexpr (!Ar::SAVING) {
+        if (a.shape < -1 || a.shape >= (int)AstroAsteroidShapes().size()) {
+            ar.Fail();
+            a.shape = -1;
+        }
+    }
+}
+
+template <class Ar, class A>
+static void VisitArena(Ar& ar, A& arena) {
+    VisitRng(ar, arena.rngAsteroids);
+    ar(arena.edgeSpawnCooldown);
+    VisitList(ar, arena.torpedoes, 41, [](Ar& in, auto& t) { VisitTorpedo(in, t); });
+    VisitList(ar, arena.asteroids, 29, [](Ar& in, auto& a) { VisitAsteroid(in, a); });
+    VisitList(ar, arena.signals, 8, [](Ar& in, auto& s) { in(s.first); in(s.second); });
+}
+
+// ===== Save =====
+void AstroSaveSnapshot(const AstroMatch& match, std::vector<uint8_t>& out) {
+    SnapshotWriter w{ out };
+    std::memcpy(w.Reserve(4), "ASSN", 4);
+    *w.Reserve(1) = (uint8_t)ASTRO_SNAPSHOT_VERSION;
+    w(match.turn);
+    w(match.running);
+    w(match.arena.matchSeed);
+    w.Count(match.ships.size(), 0);
+    for (size_t i = 0; i < match.ships.size(); ++i) {
+        w(match.ships[i]->name);
+        VisitShip(w, match.arena.ships[i]);
+    }
+    VisitArena(w, match.arena);
+    out.resize(w.n);
+}
+
+// ===== Load =====
+bool AstroLoadSnapshot(const uint8_t* data, size_t size, AstroMatch& match, std::string& error) {
+    if (size < 5 || std::memcmp(data, "ASSN", 4) != 0) {
+        error = "not an AstroBots snapshot";
+        return false;
+    }
+    if (data[4] != ASTRO_SNAPSHOT_VERSION) {
+        error = "unsupported snapshot version " + std::to_string(data[4]);
+        return false;
+    }
+    SnapshotReader r{ data + 5, data + size };
+    int turn = 0;
+    bool running = false;
+    uint64_t seed = 0;
+    r(turn);
+    r(running);
+    r(seed);
+    uint32_t count = r.Count(0, 4);
+
+    // keep the compiled programs when the roster is unchanged (the common case
+    // when forking a match repeatedly)
+    std::vector<std::string> names(count);
+    match.arena.ships.resize(count);
+    for (uint32_t i = 0; i < count && r.ok; ++i) {
+        r(names[i]);
+        VisitShip(r, match.arena.ships[i]);
+    }
+    bool sameRoster = r.ok && match.ships.size() == count;
+    for (uint32_t i = 0; sameRoster && i < count; ++i) {
+        sameRoster = match.ships[i]->name == names[i] && match.ships[i]->A == &match.arena;
+    }
+    if (r.ok && !sameRoster) {
+        std::vector<std::unique_ptr<ShipBase>> ships;
+        for (const auto& n : names) {
+            auto ship = MakeAstroShip(n);
+            if (!ship) {
+                match.Clear();
+                error = "unknown ship '" + n + "'";
+                return false;
+            }
+            ship->SetupShip();
+            ship->A = &match.arena;
+            ship->id = (int)ships.size();
+            ships.emplace_back(std::move(ship));
+        }
+        match.ships = std::move(ships);
+        match.batch.Clear();
+    }
+
+    for (size_t i = 0; i < match.arena.ships.size() && i < match.ships.size(); ++i) {
+        match.arena.ships[i].ship = match.ships[i].get();
+    }
+    match.arena.ReservePools(); // size a fresh match's pools as Setup() would
+    VisitArena(r, match.arena);
+    if (!r.ok || r.p != r.end) {
+        match.Clear();
+        error = "corrupt snapshot";
+        return false;
+    }
+    match.turn = turn;
+    match.running = running;
+    match.arena.matchSeed = seed;
+    match.arena.spatialDirty = true;
+    return true;
+}
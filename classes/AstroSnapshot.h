@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AstroMatch;
+
+// ===== AstroSnapshot: complete save/restore of a running match =====
+// Unlike a replay, which needs the whole match re-simulated to reach a turn, a
+// snapshot holds everything the next Step() reads: ships, torpedoes, asteroids
+// (by shape library index), cooldowns and the asteroid RNG stream.
+// Cosmetic effects live outside the match (AstroEffects) and are not saved; a
+// viewer that restores a snapshot starts with an empty sky. Restoring one and stepping on gives exactly the turns
+// the original match would have played, so a match can be forked mid-game for
+// what-if analysis or search-based bots. Ship programs carry no state between
+// turns, so they are stored by roster name only.
+//
+// Layout: "ASSN" u8 version, then fixed-width little endian fields (floats as
+// their IEEE bit pattern) with a u32 count ahead of every list.
+static constexpr int ASTRO_SNAPSHOT_VERSION = 4; // 2: effects moved out of the arena, 3: asteroid hull only, 4: shape library index
+
+// out is overwritten; its capacity is reused between calls
+void AstroSaveSnapshot(const AstroMatch& match, std::vector<uint8_t>& out);
+
+// Restore into match. Ship programs already in the match are reused when the
+// roster names line up, otherwise they are rebuilt from AstroShipRoster().
+// The arena log is left as is. On failure the match is cleared.
+bool AstroLoadSnapshot(const uint8_t* data, size_t size, AstroMatch& match, std::string& error);
+inline bool AstroLoadSnapshot(const std::vector<uint8_t>& bytes, AstroMatch& match, std::string& error) {
+    return AstroLoadSnapshot(bytes.data(), bytes.size(), match, error);
+}
@@ -0,0 +1,53 @@
+#include "AstroThreadPool.h"
+
+AstroThreadPool::AstroThreadPool(int threads) {
+    for (int t = 1; t < threads; ++t) _workers.emplace_back([this] { WorkerLoop(); });
+}
+
+AstroThreadPool::~AstroThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& t : _workers) t.join();
+}
+
+void AstroThreadPool::Drain() {
+    for (int i = _next++; i < _count; i = _next++) (*_fn)(i);
+}
+
+void AstroThreadPool::ParallelFor(int n, const std::function<void(int)>& fn) {
+    if (_workers.empty() || n <= 1) {
+        for (int i = 0; i < n; ++i) fn(i);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fn = &fn;
+        _count = n;
+        _next = 0;
+        _busy = (int)_workers.size();
+        ++_generation;
+    }
+    _wake.notify_all();
+    Drain();
+    std::unique_lock<std::mutex> lock(_mutex);
+    _finished.wait(lock, [this] { return _busy == 0; });
+    _fn = nullptr;
+}
+
+void AstroThreadPool::WorkerLoop() {
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [&] { return _stop || _generation != seen; });
+            if (_stop) return;
+            seen = _generation;
+        }
+        Drain();
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_busy == 0) _finished.notify_one();
+    }
+}
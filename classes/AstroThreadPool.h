@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ===== AstroThreadPool: persistent workers for per-turn parallel loops =====
+// Spawning threads every turn would cost more than running a handful of ship
+// scripts, so the workers live as long as the pool and sleep between calls.
+struct AstroThreadPool {
+    explicit AstroThreadPool(int threads); // total threads including the caller
+    ~AstroThreadPool();
+    AstroThreadPool(const AstroThreadPool&) = delete;
+    AstroThreadPool& operator=(const AstroThreadPool&) = delete;
+
+    int Size() const { return (int)_workers.size() + 1; }
+    // call fn(i) for every i in [0, n) on the workers and the calling thread;
+    // returns once all calls have finished
+    void ParallelFor(int n, const std::function<void(int)>& fn);
+
+private:
+    void WorkerLoop();
+    void Drain();
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _finished;
+    const std::function<void(int)>* _fn = nullptr;
+    int _count = 0;
+    std::atomic<int> _next{0};
+    int _busy = 0;          // workers still inside the current job
+    unsigned _generation = 0;
+    bool _stop = false;
+};
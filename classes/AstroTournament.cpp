@@ -0,0 +1,129 @@
+#include "AstroTournament.h"
+#include "AstroMatch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Derive an independent per-match seed from the tournament seed (splitmix64 finalizer)
+static uint64_t MatchSeed(uint64_t base, uint64_t index) {
+    uint64_t z = base + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// All k-element combinations of [0, n), in lexicographic order
+static void BuildFixtures(int n, int k, std::vector<std::vector<int>>& out) {
+    std::vector<int> idx(k);
+    for (int i = 0; i < k; ++i) idx[i] = i;
+    while (true) {
+        out.push_back(idx);
+        int i = k - 1;
+        while (i >= 0 && idx[i] == n - k + i) --i;
+        if (i < 0) break;
+        ++idx[i];
+        for (int j = i + 1; j < k; ++j) idx[j] = idx[j - 1] + 1;
+    }
+}
+
+static void PlayMatch(AstroMatch& match, const std::vector<std::string>& names, AstroMatchResult& r) {
+    std::vector<std::unique_ptr<ShipBase>> ships;
+    for (int e : r.entrants) {
+        ships.emplace_back(MakeAstroShip(names[e]));
+    }
+    match.Setup(std::move(ships), r.seed);
+
+    r.survivedTurns.assign(r.entrants.size(), 0);
+    while (match.Step()) {
+        for (size_t i = 0; i < match.arena.ships.size(); ++i) {
+            if (match.arena.ships[i].alive) r.survivedTurns[i] = match.turn;
+        }
+    }
+    // ships still alive when the match ends survived every turn played
+    int lastTurn = std::min(match.turn, ASTRO_MAX_TURNS);
+    for (size_t i = 0; i < match.arena.ships.size(); ++i) {
+        if (match.arena.ships[i].alive) r.survivedTurns[i] = lastTurn;
+    }
+
+    r.turns = lastTurn;
+    r.draw = match.IsDraw();
+    int w = match.Winner();
+    r.winner = (w >= 0) ? r.entrants[w] : -1;
+}
+
+bool RunAstroTournament(const AstroTournamentConfig& config, AstroTournamentResult& out, std::string& error) {
+    out = AstroTournamentResult();
+
+    std::vector<std::string> names = config.roster;
+    if (names.empty()) {
+        for (const auto& e : AstroShipRoster()) names.push_back(e.name);
+    }
+    for (const auto& n : names) {
+        if (!MakeAstroShip(n)) {
+            error = "unknown ship '" + n + "'";
+            return false;
+        }
+    }
+    int k = config.shipsPerMatch > 0 ? config.shipsPerMatch : (int)names.size();
+    if (k < 2 || k > (int)names.size()) {
+        error = "need at least 2 ships per match and no more than the roster size";
+        return false;
+    }
+
+    for (const auto& n : names) {
+        AstroShipStats st;
+        st.name = n;
+        out.ships.push_back(st);
+    }
+
+    // Schedule every fixture `rounds` times, rotating seats so spawn position isn't a bias
+    std::vector<std::vector<int>> fixtures;
+    BuildFixtures((int)names.size(), k, fixtures);
+    int rounds = std::max(1, config.rounds);
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& f : fixtures) {
+            AstroMatchResult r;
+            r.entrants = f;
+            std::rotate(r.entrants.begin(), r.entrants.begin() + (round % k), r.entrants.end());
+            r.seed = MatchSeed(config.seed, out.matches.size());
+            out.matches.push_back(r);
+        }
+    }
+
+    int threads = config.threads > 0 ? config.threads : (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    if (threads > (int)out.matches.size()) threads = (int)out.matches.size();
+    out.threads = threads;
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        AstroMatch match; // one arena per worker, reused between its matches
+        match.compiledScripts = config.compiledScripts;
+        match.batchedScripts = config.batchedScripts;
+        match.simultaneousTurns = config.simultaneousTurns;
+        for (size_t i = next++; i < out.matches.size(); i = next++) {
+            PlayMatch(match, names, out.matches[i]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Aggregate in schedule order so totals are independent of thread timing
+    for (const auto& r : out.matches) {
+        out.totalTurns += r.turns;
+        for (size_t i = 0; i < r.entrants.size(); ++i) {
+            AstroShipStats& st = out.ships[r.entrants[i]];
+            st.played++;
+            st.survivedTurns += r.survivedTurns[i];
+            if (r.winner == r.entrants[i]) st.wins++;
+            else if (r.draw && r.survivedTurns[i] == r.turns) st.draws++;
+            else st.losses++;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===== AstroTournament: parallel round-robin evaluation of ship scripts =====
+// Every combination of `shipsPerMatch` entries from the roster is a fixture, and
+// each fixture is played `rounds` times with its own seed. Matches are spread over
+// a pool of worker threads, each stepping its own AstroMatch, so nothing mutable
+// is shared between games. Results do not depend on the thread count.
+struct AstroTournamentConfig {
+    std::vector<std::string> roster; // names from AstroShipRoster(); empty = all ships
+    int shipsPerMatch = 0;           // 0 = whole roster in every match
+    int rounds = 1;                  // matches per fixture
+    uint64_t seed = 1;               // base seed, each match derives its own
+    int threads = 0;                 // 0 = one per hardware thread
+    bool compiledScripts = false;    // see AstroMatch::compiledScripts
+    bool batchedScripts = false;     // see AstroMatch::batchedScripts
+    bool simultaneousTurns = false;  // see AstroMatch::simultaneousTurns
+};
+
+struct AstroMatchResult {
+    std::vector<int> entrants;   // indices into AstroTournamentResult::ships
+    uint64_t seed = 0;           // replay with astro_sim --seed
+    int turns = 0;
+    int winner = -1;             // entrant index into ships, -1 for draw/no survivor
+    bool draw = false;
+    std::vector<int> survivedTurns; // per entrant, last turn survived (T - 1 if destroyed on turn T)
+};
+
+struct AstroShipStats {
+    std::string name;
+    int played = 0;
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    long long survivedTurns = 0; // summed over all matches played
+};
+
+struct AstroTournamentResult {
+    std::vector<AstroShipStats> ships;
+    std::vector<AstroMatchResult> matches;
+    long long totalTurns = 0;
+    double seconds = 0.0;
+    int threads = 0;
+};
+
+// returns false (with a message in error) if the roster names an unknown ship
+bool RunAstroTournament(const AstroTournamentConfig& config, AstroTournamentResult& out, std::string& error);
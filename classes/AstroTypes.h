@@ -3,8 +3,19 @@
 #include <vector>
 #include <array>
 #include <cstdint>
-#include "../imgui/imgui.h"
+#include <type_traits>
 #include "cute_c2.h"
+#include "AstroRng.h"
+
+// ===== Colors =====
+// Packed RGBA8 color, bit-compatible with ImU32/IM_COL32 so the renderer can pass
+// it straight to ImDrawList without the simulation core depending on ImGui.
+typedef uint32_t AstroColor;
+#define ASTRO_COL32_R_SHIFT 0
+#define ASTRO_COL32_G_SHIFT 8
+#define ASTRO_COL32_B_SHIFT 16
+#define ASTRO_COL32_A_SHIFT 24
+#define ASTRO_COL32(R,G,B,A) (((AstroColor)(A)<<ASTRO_COL32_A_SHIFT) | ((AstroColor)(B)<<ASTRO_COL32_B_SHIFT) | ((AstroColor)(G)<<ASTRO_COL32_G_SHIFT) | ((AstroColor)(R)<<ASTRO_COL32_R_SHIFT))
 
 // ===== Arena config =====
 static constexpr float ASTROBOTS_W = 2048.0f;
@@ -59,6 +70,15 @@ static constexpr float PARTICLE_DRAG = 0.96f;
 static constexpr float PARTICLE_LENGTH = 28.0f;        // line length scaling
 static constexpr float PARTICLE_WRAP = 1;              // wrap particles? (1=true)
 
+// Initial pool capacities (AstroArena::ReservePools, AstroEffects::Reset); pools
+// still grow past these if needed
+static constexpr size_t ASTRO_POOL_TORPEDOES = 256;
+static constexpr size_t ASTRO_POOL_ASTEROIDS = 128;
+static constexpr size_t ASTRO_POOL_EVENTS = 64;
+static constexpr size_t ASTRO_POOL_PHASER_BEAMS = 64;
+static constexpr size_t ASTRO_POOL_PARTICLES = 4096; // particle pool size; spawns beyond it are dropped
+static constexpr size_t ASTRO_POOL_DEBRIS = 512;
+
 // Ship debris (Asteroids-style breakup)
 static constexpr int SHIP_DEBRIS_LIFETIME = 60;        // frames
 static constexpr float SHIP_DEBRIS_DRAG = 0.97f;
@@ -77,6 +97,12 @@ enum AstroOpCode {
     ASTRO_OP_JUMP, ASTRO_OP_JUMP_IF_FALSE, ASTRO_OP_END
 };
 
+// actions that actually took effect during a ship's turn (ShipState::effects)
+enum AstroShipEffect {
+    ASTRO_FX_THRUST = 1 << 0, ASTRO_FX_TURN = 1 << 1, ASTRO_FX_PHASER = 1 << 2,
+    ASTRO_FX_PHOTON = 1 << 3, ASTRO_FX_SCAN = 1 << 4, ASTRO_FX_SIGNAL = 1 << 5
+};
+
 // energy costs (for compile-time budget)
 enum AstroActionCost {
     ASTRO_COST_WAIT=0, ASTRO_COST_THRUST=2, ASTRO_COST_TURN=1,
@@ -103,7 +129,7 @@ struct PhaserBeam {
     float x1, y1;  // start point
     float x2, y2;  // end point
     int lifetime;  // frames to display
-    ImU32 color;
+    AstroColor color;
     bool alive;
 };
 
@@ -114,7 +140,7 @@ struct Particle {
     float length;    // visual line length scale
     int lifetime;    // frames remaining
     int startLifetime;
-    ImU32 color;
+    AstroColor color;
     bool alive;
 };
 
@@ -126,10 +152,33 @@ struct ShipDebrisSegment {
     float angVel;     // optional spin (radians/frame) about the segment midpoint
     int lifetime;     // frames remaining
     int startLifetime;
-    ImU32 color;      // base color (used for core; glow computed at draw)
+    AstroColor color; // base color (used for core; glow computed at draw)
     bool alive;
 };
 
+// ===== Sim events =====
+// What happened during a turn, in the order it happened. The arena only records
+// them when something is listening (AstroArena::recordEvents), and nothing in
+// the simulation reads them back, so effects can never change an outcome.
+enum AstroEventType : uint8_t {
+    ASTRO_EVENT_PHASER_FIRE,         // beam from (x, y) to (x2, y2)
+    ASTRO_EVENT_PHASER_HIT_SHIP,     // at the hit point
+    ASTRO_EVENT_PHASER_HIT_ASTEROID, // at the hit point
+    ASTRO_EVENT_PHOTON_FIRE,         // at the launching ship
+    ASTRO_EVENT_TORPEDO_HIT_SHIP,    // at the ship that was hit
+    ASTRO_EVENT_TORPEDO_HIT_ASTEROID,// at the impact point
+    ASTRO_EVENT_RAM_ASTEROID,        // ship scraped an asteroid; at the ship
+    ASTRO_EVENT_SHIP_KILLED,         // at the ship; its state stays frozen once dead
+    ASTRO_EVENT_ASTEROID_BREAK       // at the broken asteroid
+};
+
+struct AstroEvent {
+    AstroEventType type;
+    int ship;       // shooter for *_FIRE, victim for *_HIT_SHIP / kills, else -1
+    float x, y;
+    float x2 = 0.0f, y2 = 0.0f;
+};
+
 // ===== Asteroid =====
 struct Asteroid {
     float x, y;
@@ -137,12 +186,30 @@ struct Asteroid {
     float size;
     int hp;
     bool alive;
-    std::vector<ImVec2> shape; // polygon vertices (relative to center)
-    // cute_c2 cached convex polygon (local space)
-    c2Poly poly;
-    bool hasPoly = false;
-
-    void GenerateShape(int sides, float radius);
+    int shape = -1; // index into AstroAsteroidShapes(); -1 while it has no geometry
+};
+static_assert(std::is_trivially_copyable<Asteroid>::value, "asteroids are moved around with plain copies");
+
+// ===== Asteroid shape library =====
+// Outlines are not generated per spawn. A fixed set per size class is built
+// once, on first use, from its own seed, so every match shares it. Spawning
+// or splitting an asteroid then picks an index with a single draw.
+enum AstroAsteroidClass {
+    ASTRO_ASTEROID_LARGE, ASTRO_ASTEROID_MEDIUM, ASTRO_ASTEROID_SMALL, ASTRO_ASTEROID_CLASSES
+};
+static constexpr int ASTRO_ASTEROID_SHAPES_PER_CLASS = 32;
+static constexpr uint64_t ASTRO_ASTEROID_SHAPE_SEED = 0x61737465726f6964ull;
+
+struct AstroAsteroidShape {
+    c2Poly poly;  // convex hull with normals, local space (drawn and collided as is)
+    c2AABB box;   // local bounds of the hull
+    float radius; // farthest hull vertex from the centre
+    float area;
 };
+// ASTRO_ASTEROID_SHAPES_PER_CLASS shapes per class, in AstroAsteroidClass order
+const std::vector<AstroAsteroidShape>& AstroAsteroidShapes();
+int AstroPickAsteroidShape(AstroAsteroidClass size, AstroRng& rng);
+// a random star-shaped outline around the origin, reduced to its convex hull
+c2Poly AstroMakeAsteroidPoly(int sides, float radius, AstroRng& rng);
 
 
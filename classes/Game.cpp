@@ -91,7 +91,6 @@ void Game::startGame()
 void Game::endTurn()
 {
 	_gameOptions.currentTurnNo++;
-	std::string startState = stateString();
 	Turn *turn = new Turn;
 	turn->_boardState = stateString();
 	turn->_date = (int)_gameOptions.currentTurnNo;